@@ -0,0 +1,60 @@
+#ifndef ASYNCQUERY_H
+#define ASYNCQUERY_H
+
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include "sqlite3.h"
+
+// Set by Ctrl+C while an InterruptCapture is active.
+inline volatile std::sig_atomic_t interruptRequested = 0;
+
+// Routes Ctrl+C to interruptRequested instead of ending the program, for
+// the lifetime of the object. The previous handler is restored afterwards,
+// so outside a running query Ctrl+C behaves as before.
+class InterruptCapture {
+public:
+    InterruptCapture() {
+        interruptRequested = 0;
+        previous = std::signal(SIGINT, [](int) { interruptRequested = 1; });
+    }
+    InterruptCapture(const InterruptCapture&) = delete;
+    InterruptCapture& operator=(const InterruptCapture&) = delete;
+    ~InterruptCapture() { std::signal(SIGINT, previous); }
+
+private:
+    void (*previous)(int);
+};
+
+// Shared between a query running on a worker thread and the thread waiting
+// on it. SQLite calls progressCallback every `interval` VM instructions;
+// returning nonzero makes the current sqlite3_step() fail with
+// SQLITE_INTERRUPT, which is how a cancel reaches a long sort or search.
+struct QueryProgress {
+    static constexpr int interval = 10000;
+    std::atomic<uint64_t> instructions{ 0 };
+    std::atomic<int> rows{ 0 };
+    std::atomic<bool> cancel{ false };
+
+    static int progressCallback(void* context) {
+        QueryProgress* progress = static_cast<QueryProgress*>(context);
+        progress->instructions.fetch_add(interval, std::memory_order_relaxed);
+        return progress->cancel.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+
+    // Installs the callback on db until the object is destroyed.
+    class Scope {
+    public:
+        Scope(sqlite3* db, QueryProgress& progress) : db(db) {
+            sqlite3_progress_handler(db, interval, &QueryProgress::progressCallback, &progress);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { sqlite3_progress_handler(db, 0, nullptr, nullptr); }
+
+    private:
+        sqlite3* db;
+    };
+};
+
+#endif // ASYNCQUERY_H
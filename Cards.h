@@ -1,7 +1,15 @@
 #ifndef CARDS_H
 #define CARDS_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "Money.h"
+#include "NameIndex.h"
+#include "SnapshotFile.h"
+#include "StringPool.h"
 
 struct CardCollection {
     int id;
@@ -12,11 +20,74 @@ struct CardCollection {
     std::string cardNumber;
     std::string condition;
     std::string reference;
-    double purchasePrice;
-    double ebayCompValue;
+    Money purchasePrice;
+    Money ebayCompValue;
     int quantity;
 };
 
+// Compact row for the loaded inventory list. type, setName and condition are
+// ids into InventoryModel::dictionary; the other text lives in its arena.
+struct CardRow {
+    int id;
+    uint32_t type;
+    std::string_view name;
+    uint32_t setName;
+    std::string_view cardNumber;
+    uint32_t condition;
+    std::string_view reference;
+    Money purchasePrice;
+    Money ebayCompValue;
+    int quantity;
+};
+
+struct InventoryModel {
+    StringPool dictionary;
+    StringArena text;
+    std::vector<CardRow> rows;
+    // Holds the snapshot file the rows' text points into when they were
+    // mapped instead of read through SQL.
+    std::unique_ptr<MappedFile> mapping;
+    // Database state the rows reflect; invalid until loaded.
+    SnapshotStamp stamp;
+    // Rows were patched in place since the snapshot was read or written.
+    bool patched = false;
+    // Names to row ids for the type-ahead picker. Built on first use and
+    // then kept current by patchRows, so only a full reload rebuilds it.
+    NameIndex names;
+
+    // The dictionary is kept across reloads; ids stay valid and the few
+    // hundred distinct values never need re-interning.
+    void clear() {
+        rows.clear();
+        text.clear();
+        mapping.reset();
+        stamp = SnapshotStamp();
+        patched = false;
+        names.clear();
+    }
+
+    bool empty() const { return rows.empty(); }
+    size_t size() const { return rows.size(); }
+
+    // Expands one row back into a full CardCollection for editing.
+    CardCollection card(size_t index) const {
+        const CardRow& row = rows[index];
+        CardCollection card;
+        card.id = row.id;
+        card.type = std::string(dictionary.get(row.type));
+        card.name = std::string(row.name);
+        card.setName = std::string(dictionary.get(row.setName));
+        card.year = 0;
+        card.cardNumber = std::string(row.cardNumber);
+        card.condition = std::string(dictionary.get(row.condition));
+        card.reference = std::string(row.reference);
+        card.purchasePrice = row.purchasePrice;
+        card.ebayCompValue = row.ebayCompValue;
+        card.quantity = row.quantity;
+        return card;
+    }
+};
+
 
 #endif // CARDS_H
 
@@ -0,0 +1,96 @@
+#ifndef CHANGECAPTURE_H
+#define CHANGECAPTURE_H
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "sqlite3.h"
+#include "SnapshotFile.h"
+
+// Records which rows of a few watched tables a connection inserts, updates
+// or deletes (through sqlite3_update_hook), so an in-memory copy of a table
+// can be brought up to date by re-reading just those rows.
+//
+// A rolled-back change still fired the hook but never bumped the table's
+// generation, so its count could balance a write from another connection
+// and hide it. Every rollback therefore drops row tracking for all watched
+// tables and forces a full reload. Transaction rollbacks are caught with
+// sqlite3_rollback_hook. Statement-level ones (ROLLBACK TO a savepoint)
+// are not reported by SQLite, so code that rolls back to a savepoint after
+// writing a watched table must call invalidate() as well.
+class ChangeCapture {
+public:
+    // Past this many distinct ids a table stops being tracked row by row,
+    // and whoever takes its changes reloads it in full instead.
+    static constexpr size_t maxTracked = 100000;
+
+    struct Changes {
+        std::unordered_set<sqlite3_int64> rowids;
+        uint64_t count = 0;     // row changes seen, repeats included
+        bool overflow = false;
+
+        // True if these changes are the only ones between two stamps of the
+        // table: the generation triggers bump once per row change, exactly
+        // as often as the hook fires. Writes from another connection break
+        // the equality and force a full reload.
+        bool cover(const SnapshotStamp& from, const SnapshotStamp& to) const {
+            return from.valid() && to.valid() && !overflow && from.userVersion == to.userVersion
+                && from.generation + static_cast<int64_t>(count) == to.generation;
+        }
+    };
+
+    explicit ChangeCapture(std::initializer_list<const char*> watched) {
+        for (const char* table : watched) tables.emplace_back(table, Changes());
+    }
+
+    void attach(sqlite3* db) {
+        sqlite3_update_hook(db, &ChangeCapture::updateCallback, this);
+        sqlite3_rollback_hook(db, &ChangeCapture::rollbackCallback, this);
+    }
+
+    // Gives up row tracking for every watched table until its changes are
+    // next taken, so each is reloaded in full.
+    void invalidate() {
+        for (auto& entry : tables) {
+            entry.second.overflow = true;
+            entry.second.rowids = std::unordered_set<sqlite3_int64>();
+        }
+    }
+
+    // Returns and forgets everything recorded for table since the last call.
+    Changes take(const char* table) {
+        for (auto& entry : tables) {
+            if (entry.first == table) return std::exchange(entry.second, Changes());
+        }
+        return Changes();
+    }
+
+private:
+    static void rollbackCallback(void* context) { static_cast<ChangeCapture*>(context)->invalidate(); }
+
+    static void updateCallback(void* context, int, const char* database, const char* table, sqlite3_int64 rowid) {
+        ChangeCapture* self = static_cast<ChangeCapture*>(context);
+        if (std::strcmp(database, "main") != 0) return;
+        for (auto& entry : self->tables) {
+            if (entry.first != table) continue;
+            Changes& changes = entry.second;
+            changes.count++;
+            if (changes.overflow) return;
+            if (changes.rowids.size() >= maxTracked) {
+                changes.overflow = true;
+                changes.rowids = std::unordered_set<sqlite3_int64>();
+                return;
+            }
+            changes.rowids.insert(rowid);
+            return;
+        }
+    }
+
+    std::vector<std::pair<std::string, Changes>> tables;
+};
+
+#endif // CHANGECAPTURE_H
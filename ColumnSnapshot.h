@@ -0,0 +1,63 @@
+#ifndef COLUMNSNAPSHOT_H
+#define COLUMNSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Struct-of-arrays copy of the numeric inventory and sales columns. Totals
+// are computed by streaming over these dense arrays instead of over
+// CardCollection/soldCard rows, whose strings would drag through the cache.
+// Prices are Money cents and quantities stay 32-bit, so each inventory row
+// is 20 bytes and every total is an exact integer.
+struct InventoryColumns {
+    std::vector<int64_t> purchasePrice;
+    std::vector<int64_t> ebayCompValue;
+    std::vector<int32_t> quantity;
+};
+
+struct SalesColumns {
+    std::vector<int64_t> finalSoldPrice;
+    std::vector<int64_t> profitMade;
+    std::vector<int32_t> quantitySold;
+};
+
+struct ColumnSnapshot {
+    InventoryColumns inventory;
+    SalesColumns sales;
+    bool loaded = false;
+    const void* source = nullptr; // connection the stamps below come from
+    int64_t changeStamp = -1; // sqlite3_total_changes64() when loaded
+    int dataVersion = -1;     // PRAGMA data_version when loaded
+};
+
+// Aggregation kernels. Each keeps four independent accumulators so the loop
+// has no serial dependency on one register. Integer sums are exact and do
+// not depend on summation order, so totals can also be combined afterwards
+// (profit = value - cost) instead of taking another pass.
+inline int64_t sumColumn(const std::vector<int64_t>& a) {
+    const int64_t* p = a.data();
+    size_t n = a.size(), i = 0;
+    int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += p[i]; s1 += p[i + 1]; s2 += p[i + 2]; s3 += p[i + 3];
+    }
+    for (; i < n; ++i) s0 += p[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+// sum(a[i] * b[i])
+inline int64_t sumProduct(const std::vector<int64_t>& a, const std::vector<int32_t>& b) {
+    const int64_t* pa = a.data();
+    const int32_t* pb = b.data();
+    size_t n = a.size(), i = 0;
+    int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += pa[i] * pb[i]; s1 += pa[i + 1] * pb[i + 1];
+        s2 += pa[i + 2] * pb[i + 2]; s3 += pa[i + 3] * pb[i + 3];
+    }
+    for (; i < n; ++i) s0 += pa[i] * pb[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+#endif // COLUMNSNAPSHOT_H
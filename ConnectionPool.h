@@ -0,0 +1,124 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Database.h"
+#include "StorageProfile.h"
+
+// One writer connection plus a pool of read-only connections to the same
+// file. In WAL mode a reader sees a consistent snapshot from its first step
+// to its reset and neither blocks nor is blocked by the writer, so listings,
+// analytics and exports can run (on any thread) while edits continue. Under
+// a rollback-journal profile the readers still work but serialize with it:
+// every connection waits up to busyTimeoutMs for the others' locks instead
+// of failing at once with SQLITE_BUSY.
+class ConnectionPool {
+public:
+    static constexpr int busyTimeoutMs = 5000;
+    static constexpr std::chrono::milliseconds readerWait{ 250 };
+
+    // A borrowed reader, handed back to the pool when it goes out of scope.
+    class Lease {
+    public:
+        Lease(ConnectionPool& pool, Database* db) : pool(&pool), db(db) {}
+        Lease(Lease&& other) noexcept : pool(other.pool), db(other.db) { other.db = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { if (db) pool->release(db); }
+
+        Database& operator*() const { return *db; }
+        Database* operator->() const { return db; }
+
+    private:
+        ConnectionPool* pool;
+        Database* db;
+    };
+
+    bool open(const char* filename) {
+        path = filename;
+        if (!primary.open(filename)) return false;
+        sqlite3_busy_timeout(primary.handle(), busyTimeoutMs);
+        return true;
+    }
+
+    // Readers open read-only, so the file and schema must exist first.
+    bool openReaders(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto reader = std::make_unique<Database>();
+            if (!reader->open(path.c_str(), SQLITE_OPEN_READONLY)) return false;
+            sqlite3_busy_timeout(reader->handle(), busyTimeoutMs);
+            sqlite3_exec(reader->handle(), "PRAGMA query_only = ON;", 0, 0, 0);
+            readers.push_back(std::move(reader));
+            idle.push_back(readers.back().get());
+        }
+        return true;
+    }
+
+    Database& writer() { return primary; }
+
+    // For the thread that owns the writer. With no readers configured, or
+    // none free within readerWait (all held by background exports, say),
+    // reads share the writer connection (the single-connection behaviour)
+    // rather than waiting for an export to finish.
+    Lease reader() {
+        if (readers.empty()) return Lease(*this, &primary);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!available.wait_for(lock, readerWait, [&] { return !idle.empty(); })) return Lease(*this, &primary);
+        return take();
+    }
+
+    // For worker threads, which must not touch the writer: blocks until a
+    // reader is free. Needs at least one reader.
+    Lease awaitReader() {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [&] { return !idle.empty(); });
+        return take();
+    }
+
+    // Applies the read-side settings of a profile (page cache and mmap) to
+    // every reader; journal mode and syncing belong to the writer.
+    void configureReaders(const StorageProfile* profile) {
+        std::string sql = "PRAGMA mmap_size = " + std::to_string(profile->mmapSize) + ";"
+            "PRAGMA cache_size = " + std::to_string(profile->cacheSize) + ";";
+        for (auto& reader : readers) sqlite3_exec(reader->handle(), sql.c_str(), 0, 0, 0);
+    }
+
+    template <typename Fn>
+    void forEachConnection(Fn fn) {
+        fn(primary);
+        for (auto& reader : readers) fn(*reader);
+    }
+
+    size_t readerCount() const { return readers.size(); }
+
+private:
+    // Caller holds mutex and has seen a free reader.
+    Lease take() {
+        Database* db = idle.back();
+        idle.pop_back();
+        return Lease(*this, db);
+    }
+
+    void release(Database* db) {
+        if (db == &primary) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(db);
+        }
+        available.notify_one();
+    }
+
+    Database primary;
+    std::string path;
+    std::vector<std::unique_ptr<Database>> readers;
+    std::vector<Database*> idle;
+    std::mutex mutex;
+    std::condition_variable available;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -7,48 +7,213 @@
 #include <cctype>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <string_view>
+#include <thread>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <future>
+#include <mutex>
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include "sqlite3.h"
 #include "Cards.h"
 #include "Sales.h"
+#include "Money.h"
+#include "Database.h"
+#include "ConnectionPool.h"
+#include "CsvReader.h"
+#include "ImportBatch.h"
+#include "BoundedQueue.h"
+#include "PageWriter.h"
+#include "ListingQuery.h"
+#include "ColumnSnapshot.h"
+#include "SyntheticCollection.h"
+#include "Profiler.h"
+#include "AsyncQuery.h"
+#include "ChangeCapture.h"
+#include "Terminal.h"
 #include "conio.h"
 using namespace std;
 
 // Forward Declarations for all functions
-void initializeDatabase(sqlite3* db);
-void loadInventory(vector<CardCollection>& inventory, sqlite3* db);
-void loadSalesLog(vector<soldCard>& sales, sqlite3* db);
-void showDashboard(const vector <CardCollection>& inventory, const vector<soldCard>& salesLog);
-void addCard(sqlite3* db);
-void editCard(vector<CardCollection>& inventory, sqlite3* db);
-void printInventory(sqlite3* db);
-void analyzeInventory(sqlite3* db);
-void analyzeSales(sqlite3* db);
-void printSalesLog(sqlite3* db);
-void displayCardDetails(const CardCollection& card);
-void displaySoldCardDetails(const soldCard& sale);
-void deleteSale(vector<soldCard>& sales, sqlite3* db);
-void importFromCSV(sqlite3* db, const string& filename);
-
-int main() {
-    sqlite3* db;
-    int rc = sqlite3_open("inventory.db", &db);
-
-    if (rc) {
-        cerr << "Error opening database: " << sqlite3_errmsg(db) << endl;
+bool initializeDatabase(Database& db);
+void initializeSearchIndex(Database& db);
+bool runMigrations(Database& db);
+string buildFtsQuery(const string& column, const string& term);
+Money columnMoney(sqlite3_stmt* stmt, int col);
+void loadInventory(InventoryModel& inventory, Database& db);
+void loadSalesLog(SalesModel& sales, Database& db);
+void readInventoryRows(InventoryModel& inventory, Database& db);
+void readSalesRows(SalesModel& sales, Database& db);
+SnapshotStamp readSnapshotStamp(Database& db, const char* table);
+string snapshotPath(Database& db, const char* table);
+bool writeInventorySnapshot(const InventoryModel& inventory, const string& path);
+bool writeSalesSnapshot(const SalesModel& sales, const string& path);
+void saveSnapshots(Database& db, InventoryModel& inventory, SalesModel& sales);
+void showDashboard(Database& db);
+void addCard(Database& db);
+void editCard(InventoryModel& inventory, Database& db);
+void printInventory(Database& db);
+ListingQuery inventoryListingQuery(Database& db, int sortChoice, const string& searchTerm);
+ListingQuery salesListingQuery(Database& db, int sortChoice, const string& searchTerm);
+string buildPageSql(const ListingQuery& query, const string& cursorOp, bool reverse);
+void bindPageQuery(sqlite3_stmt* stmt, const ListingQuery& query, sqlite3_value* cursorKey, sqlite3_int64 cursorId, int limit);
+void analyzeInventory(Database& db, ColumnSnapshot& snapshot);
+void analyzeSales(Database& db, ColumnSnapshot& snapshot);
+void salesReports(Database& db);
+void refreshSnapshot(Database& db, ColumnSnapshot& snapshot);
+void printSalesLog(Database& db);
+void displayCardDetails(PageWriter& out, sqlite3_stmt* stmt);
+void displaySoldCardDetails(PageWriter& out, sqlite3_stmt* stmt);
+void runPagedListing(Database& db, const ListingQuery& query, void (*displayRow)(PageWriter&, sqlite3_stmt*), const char* emptyMessage, int topN);
+bool tableExists(Database& db, const char* name);
+void deleteSale(SalesModel& sales, Database& db);
+bool recordSale(Database& db, const CardCollection& card, int quantity, Money pricePerCard, sqlite3_int64* saleId = nullptr);
+bool loadCardById(Database& db, int id, CardCollection& card);
+bool checkout(Database& db, const vector<CheckoutLine>& cart, string& error);
+void checkoutCart(Database& db);
+bool execCached(Database& db, const char* sql);
+void runBatch(Database& db, const string& script, int batchSize);
+void runBenchmark(Database& db, size_t rows, int runs);
+bool parseRowCount(const char* text, size_t& rows);
+bool exportListing(Database& db, const ListingQuery& query, ostream& out, bool json, size_t& rows);
+void runExport(Database& db, const string& table, const string& path, bool json, const string& where);
+void exportInBackground(ConnectionPool& pool, vector<thread>& workers);
+void applyStorageProfile(Database& db, const StorageProfile* profile);
+const StorageProfile* switchStorageProfile(Database& db, const StorageProfile* profile);
+void importFromCSV(Database& db, const string& filename);
+void importFromCSVParallel(Database& db, const string& filename, unsigned threadCount);
+void repriceFromFeed(Database& db, const string& filename);
+void consolidateDuplicates(Database& db);
+string trim(const string& str);
+
+// Statement and function timings; off unless started with --trace.
+Profiler profiler;
+// Rows the writer connection has changed since the models last caught up.
+ChangeCapture changeCapture({ "inventory", "sales" });
+
+int main(int argc, char* argv[]) {
+    // Non-interactive mode: tcdb --batch <script|-> [--batch-size N]
+    // Benchmarks: tcdb --bench <rows, e.g. 10k|1m|10m, at most 10m> [--bench-runs N]
+    // Export: --export inventory|sales <file|-> [--format csv|ndjson]
+    //         [--where <listing mode>[:search term]]
+    // Repricing: --reprice <feed.csv>
+    // Duplicates: --consolidate merges repeated copies of the same card.
+    // Concurrency: --readers N read-only connections for listings, analysis,
+    // reports and exports (default 2; 0 reads on the writer connection).
+    // Profiling: --trace table|json records statement and function timings
+    // and writes them to stderr on exit (or from menu option 6).
+    // Storage: --profile durable|balanced|bulk-load (default balanced) and
+    // --bulk-profile for imports and batch runs (default bulk-load).
+    string batchScript;
+    int batchSize = 1000;
+    size_t benchRows = 0;
+    int benchRuns = 5;
+    string traceFormat;
+    string exportTable, exportPath, exportWhere;
+    string repriceFeed;
+    bool consolidate = false;
+    size_t readerCount = 2;
+    bool exportJson = false;
+    const StorageProfile* profile = findStorageProfile("balanced");
+    const StorageProfile* bulkProfile = findStorageProfile("bulk-load");
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--batch" && i + 1 < argc) batchScript = argv[++i];
+        else if (arg == "--batch-size" && i + 1 < argc) batchSize = max(1, atoi(argv[++i]));
+        else if (arg == "--bench" && i + 1 < argc && parseRowCount(argv[i + 1], benchRows)) ++i;
+        else if (arg == "--bench-runs" && i + 1 < argc) benchRuns = max(1, atoi(argv[++i]));
+        else if (arg == "--export" && i + 2 < argc && (string(argv[i + 1]) == "inventory" || string(argv[i + 1]) == "sales")) {
+            exportTable = argv[++i];
+            exportPath = argv[++i];
+        }
+        else if (arg == "--format" && i + 1 < argc && (string(argv[i + 1]) == "csv" || string(argv[i + 1]) == "ndjson")) exportJson = string(argv[++i]) == "ndjson";
+        else if (arg == "--where" && i + 1 < argc) exportWhere = argv[++i];
+        else if (arg == "--reprice" && i + 1 < argc) repriceFeed = argv[++i];
+        else if (arg == "--consolidate") consolidate = true;
+        else if (arg == "--readers" && i + 1 < argc) readerCount = (size_t)max(0, atoi(argv[++i]));
+        else if (arg == "--trace" && i + 1 < argc && (string(argv[i + 1]) == "table" || string(argv[i + 1]) == "json")) traceFormat = argv[++i];
+        else if (arg == "--profile" && i + 1 < argc && findStorageProfile(argv[i + 1])) profile = findStorageProfile(argv[++i]);
+        else if (arg == "--bulk-profile" && i + 1 < argc && findStorageProfile(argv[i + 1])) bulkProfile = findStorageProfile(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--batch <script|-> [--batch-size N]] [--bench <rows> [--bench-runs N]] [--trace table|json]"
+                << " [--export inventory|sales <file|-> [--format csv|ndjson] [--where mode[:term]]] [--reprice <feed.csv>] [--consolidate] [--readers N]"
+                << " [--profile durable|balanced|bulk-load] [--bulk-profile durable|balanced|bulk-load]\n";
+            return 1;
+        }
+    }
+
+    // Benchmarks always start from an empty scratch database.
+    const char* dbFile = benchRows > 0 ? "bench.db" : "inventory.db";
+    if (benchRows > 0) {
+        for (const char* suffix : { "", "-wal", "-shm", "-journal", "-inventory.snap", "-sales.snap" }) remove((string(dbFile) + suffix).c_str());
+    }
+
+    ConnectionPool pool;
+    Database& db = pool.writer();
+
+    if (!pool.open(dbFile)) {
+        cerr << "Error opening database: " << sqlite3_errmsg(db.handle()) << endl;
         return 1;
     }
 
-    initializeDatabase(db);
+    if (!traceFormat.empty()) profiler.enable(db.handle());
+    changeCapture.attach(db.handle());
+    vector<thread> backgroundExports;
+    auto finish = [&](int code) {
+        for (thread& worker : backgroundExports) worker.join();
+        if (profiler.enabled()) profiler.report(cerr, traceFormat == "json");
+        return code;
+    };
+
+    applyStorageProfile(db, profile);
+    db.setBulkProfile(bulkProfile);
+    if (!initializeDatabase(db)) {
+        cerr << "The database schema could not be brought up to date. Exiting." << endl;
+        return finish(1);
+    }
+
+    // Listings, analysis, reports and exports read through these, so they
+    // work from their own WAL snapshot instead of queueing behind edits.
+    if (!pool.openReaders(readerCount)) {
+        cerr << "Error opening read connections: " << sqlite3_errmsg(db.handle()) << endl;
+        return 1;
+    }
+    pool.configureReaders(profile);
+    if (!traceFormat.empty()) pool.forEachConnection([](Database& conn) { profiler.enable(conn.handle()); });
+
+    if (!batchScript.empty()) {
+        runBatch(db, batchScript, batchSize);
+        return finish(0);
+    }
+    if (benchRows > 0) {
+        runBenchmark(db, benchRows, benchRuns);
+        return finish(0);
+    }
+    if (!exportTable.empty()) {
+        runExport(*pool.reader(), exportTable, exportPath, exportJson, exportWhere);
+        return finish(0);
+    }
+    if (!repriceFeed.empty()) {
+        repriceFromFeed(db, repriceFeed);
+        return finish(0);
+    }
+    if (consolidate) {
+        consolidateDuplicates(db);
+        return finish(0);
+    }
 
-    vector<CardCollection> inventory;
-    vector<soldCard> salesLog;
+    InventoryModel inventory;
+    SalesModel salesLog;
+    ColumnSnapshot snapshot;
 
     int choice = 0;
     while (true) {
-        loadInventory(inventory, db);
-        loadSalesLog(salesLog, db);
-
-        showDashboard(inventory, salesLog);
+        showDashboard(db);
 
         cout << "\n--- Main Menu ---\n";
         cout << "1. Add a new Card\n";
@@ -56,6 +221,11 @@ int main() {
         cout << "3. View/Search Inventory \n";
         cout << "4. Analyze inventory or Sale Logs\n";
         cout << "5. Import Cards from external CSV\n";
+        cout << "6. Show performance profile\n";
+        cout << "7. Checkout (sell several cards at once)\n";
+        cout << "8. Reprice inventory from a price feed\n";
+        cout << "9. Export inventory or sales in the background\n";
+        cout << "10. Merge duplicate cards\n";
         cout << "0. Exit\n";
         cout << "Enter your choice: ";
         cin >> choice;
@@ -70,10 +240,11 @@ int main() {
             addCard(db);
             break;
         case 2:
+            loadInventory(inventory, db);
             editCard(inventory, db);
             break;
         case 3:
-            printInventory(db);
+            printInventory(*pool.reader());
             break;
         case 4: {
             int analysisChoice;
@@ -90,25 +261,32 @@ int main() {
             }
 
             if (analysisChoice == 1) {
-                analyzeInventory(db);
+                analyzeInventory(*pool.reader(), snapshot);
             }
             else if (analysisChoice == 2) {
                 cout << "\n--- Sales Log Management ---\n";
                 cout << "1. View and Sort Sales\n";
                 cout << "2. Delete a Sale\n";
+                cout << "3. Period Reports (daily, monthly, by type or set)\n";
                 cout << "0. Go Back\n";
                 cout << "Enter your choice: ";
 
                 int salesLogChoice;
                 cin >> salesLogChoice;
                 switch (salesLogChoice) {
-                case 1:
-                    printSalesLog(db);
-                    analyzeSales(db);
+                case 1: {
+                    auto reader = pool.reader();
+                    printSalesLog(*reader);
+                    analyzeSales(*reader, snapshot);
                     break;
+                }
                 case 2:
+                    loadSalesLog(salesLog, db);
                     deleteSale(salesLog, db);
                     break;
+                case 3:
+                    salesReports(*pool.reader());
+                    break;
                 case 0:
                     break;
                 default:
@@ -118,13 +296,51 @@ int main() {
             }
             break;
         }
-        case 5:
-            importFromCSV(db, "import.csv");
-                break;
+        case 5: {
+            string path;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "CSV file to import (blank for import.csv): ";
+            getline(cin, path);
+            path = trim(path);
+            if (path.empty()) path = "import.csv";
+
+            int threads = 1;
+            cout << "Parse threads (1 = single-threaded, 0 = all cores): ";
+            cin >> threads;
+            if (cin.fail() || threads < 0) {
+                cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                threads = 1;
+            }
+            if (threads == 1) importFromCSV(db, path);
+            else importFromCSVParallel(db, path, (unsigned)threads);
+            break;
+        }
+        case 6:
+            if (profiler.enabled()) profiler.report(cout, traceFormat == "json");
+            else cout << "Profiling is off; start the program with --trace table or --trace json.\n";
+            break;
+        case 7:
+            checkoutCart(db);
+            break;
+        case 8: {
+            string path;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Price feed file (blank for prices.csv): ";
+            getline(cin, path);
+            path = trim(path);
+            repriceFromFeed(db, path.empty() ? "prices.csv" : path);
+            break;
+        }
+        case 9:
+            exportInBackground(pool, backgroundExports);
+            break;
+        case 10:
+            consolidateDuplicates(db);
+            break;
         case 0:
             cout << "Exiting Program\n";
-            sqlite3_close(db);
-            return 0;
+            saveSnapshots(db, inventory, salesLog);
+            return finish(0);
         default:
             cout << "That was not an option presented, please try again\n";
             break;
@@ -139,28 +355,35 @@ string trim(const string& str) {
     return str.substr(first, last - first + 1);
 }
 
-void displayCardDetails(const CardCollection& card) {
-    cout << "Name: " << card.name << "\n";
-    cout << "Set: " << card.setName << " (" << card.cardNumber << ")\n";
-    cout << "Condition: " << card.condition << "\n";
-    cout << "Purchase Price: $" << fixed << setprecision(2) << card.purchasePrice << "\n";
-    cout << "Ebay Comp Value: $" << fixed << setprecision(2) << card.ebayCompValue << "\n";
-    cout << "Quantity: " << card.quantity << "\n";
-    cout << "Reference#: " << card.reference << "\n";
-    cout << "-----------------------------\n";
+// Row formatters for the paged listings. They read the listing's columns
+// straight from the statement (id, type, name, setName, cardNumber,
+// condition, reference, then the numeric columns) into the page buffer.
+void displayCardDetails(PageWriter& out, sqlite3_stmt* stmt) {
+    out << "Name: " << sqlite3_column_text(stmt, 2) << "\n";
+    out << "Set: " << sqlite3_column_text(stmt, 3) << " (" << sqlite3_column_text(stmt, 4) << ")\n";
+    out << "Condition: " << sqlite3_column_text(stmt, 5) << "\n";
+    out << "Purchase Price: $"; out.money(columnMoney(stmt, 7)) << "\n";
+    out << "Ebay Comp Value: $"; out.money(columnMoney(stmt, 8)) << "\n";
+    out << "Quantity: " << sqlite3_column_int(stmt, 9) << "\n";
+    out << "Reference#: " << sqlite3_column_text(stmt, 6) << "\n";
+    out << "-----------------------------\n";
 }
 
-void displaySoldCardDetails(const soldCard& sales) {
-        cout << "Card: " << sales.name
-            << " | Set: " << sales.setName
-            << " | Qty: " << sales.quantitySold
-            << " | Sold Price: $" << fixed << setprecision(2) << sales.finalSoldPrice
-            << " | Profit Made: $" << sales.profitMade << "\n";
-        cout << "--------------------------------------\n";
-    }
+void displaySoldCardDetails(PageWriter& out, sqlite3_stmt* stmt) {
+    out << "Card: " << sqlite3_column_text(stmt, 2)
+        << " | Set: " << sqlite3_column_text(stmt, 3)
+        << " | Qty: " << sqlite3_column_int(stmt, 10)
+        << " | Sold Price: $"; out.money(columnMoney(stmt, 8))
+        << " | Profit Made: $"; out.money(columnMoney(stmt, 9));
+    if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) out << " | Sold: " << sqlite3_column_text(stmt, 11);
+    out << "\n";
+    out << "--------------------------------------\n";
+}
 
-void initializeDatabase(sqlite3* db) {
-    char* zErrMsg = 0;
+// Creates the tables and brings the schema up to date. False if any step
+// failed, in which case the program must not run against the file: the code
+// assumes the latest schema (amounts in cents, say) throughout.
+bool initializeDatabase(Database& db) {
     const char* sqlInventory =
         "CREATE TABLE IF NOT EXISTS inventory ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -171,7 +394,7 @@ void initializeDatabase(sqlite3* db) {
         "condition TEXT,"
         "purchasePrice REAL NOT NULL,"
         "ebayCompValue REAL NOT NULL,"
-        "reference TEXT."
+        "reference TEXT,"
         "quantity INTEGER NOT NULL);";
 
     const char* sqlSales =
@@ -182,90 +405,997 @@ void initializeDatabase(sqlite3* db) {
         "setName TEXT NOT NULL,"
         "cardNumber TEXT,"
         "condition TEXT,"
-        "reference TEXT"
+        "reference TEXT,"
         "purchasePrice REAL NOT NULL,"
         "finalSoldPrice REAL NOT NULL,"
         "profitMade REAL NOT NULL,"
         
         "quantitySold INTEGER NOT NULL);";
 
-    sqlite3_exec(db, sqlInventory, 0, 0, &zErrMsg);
-    sqlite3_exec(db, sqlSales, 0, 0, &zErrMsg);
+    // Running totals for the dashboard. A single row kept current by triggers so
+    // showDashboard() never has to scan either table. Seeded once from the
+    // existing rows the first time it is created; amounts are in cents.
+    const char* sqlTotals =
+        "CREATE TABLE IF NOT EXISTS dashboard_totals ("
+        "id INTEGER PRIMARY KEY CHECK (id = 1),"
+        "totCards INTEGER NOT NULL DEFAULT 0,"
+        "totMarketValue INTEGER NOT NULL DEFAULT 0,"
+        "totSoldCards INTEGER NOT NULL DEFAULT 0,"
+        "totSaleValue INTEGER NOT NULL DEFAULT 0,"
+        "totNetProfit INTEGER NOT NULL DEFAULT 0);"
+        "INSERT OR IGNORE INTO dashboard_totals (id, totCards, totMarketValue, totSoldCards, totSaleValue, totNetProfit) SELECT 1,"
+        "(SELECT IFNULL(SUM(quantity), 0) FROM inventory),"
+        "(SELECT IFNULL(SUM(ebayCompValue * quantity), 0) FROM inventory),"
+        "(SELECT IFNULL(SUM(quantitySold), 0) FROM sales),"
+        "(SELECT IFNULL(SUM(finalSoldPrice), 0) FROM sales),"
+        "(SELECT IFNULL(SUM(profitMade), 0) FROM sales);";
+
+    const char* sqlTotalsTriggers =
+        "CREATE TRIGGER IF NOT EXISTS inventory_totals_ai AFTER INSERT ON inventory BEGIN "
+        "UPDATE dashboard_totals SET totCards = totCards + NEW.quantity,"
+        "totMarketValue = totMarketValue + NEW.ebayCompValue * NEW.quantity WHERE id = 1; END;"
+        "CREATE TRIGGER IF NOT EXISTS inventory_totals_ad AFTER DELETE ON inventory BEGIN "
+        "UPDATE dashboard_totals SET totCards = totCards - OLD.quantity,"
+        "totMarketValue = totMarketValue - OLD.ebayCompValue * OLD.quantity WHERE id = 1; END;"
+        "CREATE TRIGGER IF NOT EXISTS inventory_totals_au AFTER UPDATE OF quantity, ebayCompValue ON inventory BEGIN "
+        "UPDATE dashboard_totals SET totCards = totCards + NEW.quantity - OLD.quantity,"
+        "totMarketValue = totMarketValue + NEW.ebayCompValue * NEW.quantity - OLD.ebayCompValue * OLD.quantity WHERE id = 1; END;"
+        "CREATE TRIGGER IF NOT EXISTS sales_totals_ai AFTER INSERT ON sales BEGIN "
+        "UPDATE dashboard_totals SET totSoldCards = totSoldCards + NEW.quantitySold,"
+        "totSaleValue = totSaleValue + NEW.finalSoldPrice,"
+        "totNetProfit = totNetProfit + NEW.profitMade WHERE id = 1; END;"
+        "CREATE TRIGGER IF NOT EXISTS sales_totals_ad AFTER DELETE ON sales BEGIN "
+        "UPDATE dashboard_totals SET totSoldCards = totSoldCards - OLD.quantitySold,"
+        "totSaleValue = totSaleValue - OLD.finalSoldPrice,"
+        "totNetProfit = totNetProfit - OLD.profitMade WHERE id = 1; END;"
+        "CREATE TRIGGER IF NOT EXISTS sales_totals_au AFTER UPDATE OF quantitySold, finalSoldPrice, profitMade ON sales BEGIN "
+        "UPDATE dashboard_totals SET totSoldCards = totSoldCards + NEW.quantitySold - OLD.quantitySold,"
+        "totSaleValue = totSaleValue + NEW.finalSoldPrice - OLD.finalSoldPrice,"
+        "totNetProfit = totNetProfit + NEW.profitMade - OLD.profitMade WHERE id = 1; END;";
+
+    // Each step builds on the one before, so the first failure is reported
+    // (with its own message) and the rest are skipped.
+    auto run = [&](const char* sql, const char* step) {
+        char* zErrMsg = 0;
+        if (sqlite3_exec(db.handle(), sql, 0, 0, &zErrMsg) == SQLITE_OK) return true;
+        cerr << "SQL error creating " << step << ": " << (zErrMsg ? zErrMsg : sqlite3_errmsg(db.handle())) << endl;
+        sqlite3_free(zErrMsg);
+        return false;
+    };
+    if (!run(sqlInventory, "the inventory table") || !run(sqlSales, "the sales table")) return false;
+    if (!runMigrations(db)) return false;
+    if (!run(sqlTotals, "the dashboard totals") || !run(sqlTotalsTriggers, "the dashboard triggers")) return false;
+
+    initializeSearchIndex(db);
+    return true;
+}
+
+// ===================================================================
+// STORAGE PROFILES
+// ===================================================================
+
+// Applies every PRAGMA of a profile to the connection. Must be called
+// outside a transaction, since journal_mode cannot change inside one.
+void applyStorageProfile(Database& db, const StorageProfile* profile) {
+    const StorageProfile* previous = db.profile();
+    if (previous && previous->checkpointOnLeave && previous != profile) {
+        sqlite3_wal_checkpoint_v2(db.handle(), NULL, SQLITE_CHECKPOINT_TRUNCATE, NULL, NULL);
+    }
+
+    string sql =
+        "PRAGMA journal_mode = " + string(profile->journalMode) + ";"
+        "PRAGMA synchronous = " + string(profile->synchronous) + ";"
+        "PRAGMA mmap_size = " + to_string(profile->mmapSize) + ";"
+        "PRAGMA cache_size = " + to_string(profile->cacheSize) + ";"
+        "PRAGMA temp_store = " + string(profile->tempStore) + ";"
+        "PRAGMA wal_autocheckpoint = " + to_string(profile->walAutoCheckpoint) + ";";
+    char* zErrMsg = 0;
+    if (sqlite3_exec(db.handle(), sql.c_str(), 0, 0, &zErrMsg) != SQLITE_OK) {
+        cerr << "Error applying storage profile " << profile->name << ": " << zErrMsg << endl;
+        sqlite3_free(zErrMsg);
+    }
+    db.setProfile(profile);
+}
+
+// Switches to another profile for the duration of a bulk operation and
+// returns the one to switch back to afterwards.
+const StorageProfile* switchStorageProfile(Database& db, const StorageProfile* profile) {
+    const StorageProfile* previous = db.profile();
+    if (profile && profile != previous) applyStorageProfile(db, profile);
+    return previous;
+}
 
-    if (zErrMsg) {
-        cerr << "SQL error initializing database: " << zErrMsg << endl;
+// ===================================================================
+// SCHEMA MIGRATIONS
+// ===================================================================
+// Each migration upgrades the schema by one step and is recorded in
+// PRAGMA user_version, so existing inventory.db files are brought up to
+// date in place on startup. Append new steps to the end of the list; never
+// reorder or edit one that has shipped.
+
+struct Migration {
+    int version;
+    const char* description;
+    bool (*apply)(Database& db, string& error);
+};
+
+bool execMigrationSql(Database& db, const char* sql, string& error) {
+    char* zErrMsg = 0;
+    if (sqlite3_exec(db.handle(), sql, 0, 0, &zErrMsg) != SQLITE_OK) {
+        error = zErrMsg ? zErrMsg : sqlite3_errmsg(db.handle());
         sqlite3_free(zErrMsg);
+        return false;
+    }
+    return true;
+}
+
+bool tableHasColumn(Database& db, const char* table, const char* column) {
+    Statement stmt = db.prepare("SELECT 1 FROM pragma_table_info(?) WHERE name = ?;");
+    sqlite3_bind_text(stmt, 1, table, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, column, -1, SQLITE_TRANSIENT);
+    return sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+// Older builds created sales with a missing comma after "reference TEXT",
+// which folded purchasePrice into reference's type name. Rebuild the table
+// with the intended columns, keeping ids and every value that was stored.
+bool migrateRepairSalesTable(Database& db, string& error) {
+    if (tableHasColumn(db, "sales", "purchasePrice")) return true;
+    return execMigrationSql(db,
+        "DROP TABLE IF EXISTS sales_fts;"
+        "CREATE TABLE sales_repaired ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "type TEXT NOT NULL,"
+        "name TEXT NOT NULL,"
+        "setName TEXT NOT NULL,"
+        "cardNumber TEXT,"
+        "condition TEXT,"
+        "reference TEXT,"
+        "purchasePrice REAL NOT NULL,"
+        "finalSoldPrice REAL NOT NULL,"
+        "profitMade REAL NOT NULL,"
+        "quantitySold INTEGER NOT NULL);"
+        "INSERT INTO sales_repaired (id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold) "
+        "SELECT id, type, name, setName, cardNumber, condition, reference, (finalSoldPrice - profitMade) / MAX(quantitySold, 1), finalSoldPrice, profitMade, quantitySold FROM sales;"
+        "DROP TABLE sales;"
+        "ALTER TABLE sales_repaired RENAME TO sales;", error);
+}
+
+// Indexes for every lookup and ORDER BY key used by addCard(),
+// printInventory() and printSalesLog().
+bool migrateAddLookupIndexes(Database& db, string& error) {
+    return execMigrationSql(db,
+        "CREATE INDEX IF NOT EXISTS idx_inventory_identity ON inventory(type, name, setName, condition, reference);"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_name ON inventory(name);"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_setName ON inventory(setName);"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_ebayCompValue ON inventory(ebayCompValue);"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_reference ON inventory(reference);"
+        "CREATE INDEX IF NOT EXISTS idx_sales_profitMade ON sales(profitMade, id);"
+        "CREATE INDEX IF NOT EXISTS idx_sales_name ON sales(name);"
+        "CREATE INDEX IF NOT EXISTS idx_sales_reference ON sales(reference);", error);
+}
+
+// Per-row market value and potential profit as virtual generated columns.
+// They take no space in the table, but their indexes let the "highest value"
+// and "highest profit" listings read rows in order instead of computing and
+// sorting the expression over the whole table.
+bool migrateAddValueColumns(Database& db, string& error) {
+    return execMigrationSql(db,
+        "ALTER TABLE inventory ADD COLUMN marketValue REAL GENERATED ALWAYS AS (ebayCompValue * quantity) VIRTUAL;"
+        "ALTER TABLE inventory ADD COLUMN potentialProfit REAL GENERATED ALWAYS AS ((ebayCompValue - purchasePrice) * quantity) VIRTUAL;"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_marketValue ON inventory(marketValue);"
+        "CREATE INDEX IF NOT EXISTS idx_inventory_potentialProfit ON inventory(potentialProfit);", error);
+}
+
+// Paged listings walk (sortKey, id) in index order; type was the only sort
+// key without an index of its own.
+bool migrateAddTypeIndex(Database& db, string& error) {
+    return execMigrationSql(db, "CREATE INDEX IF NOT EXISTS idx_inventory_type ON inventory(type);", error);
+}
+
+// A summary table over sales grouped by some key, kept current by triggers.
+// keyExpr uses "$" for the row, replaced by sales / NEW / OLD as needed.
+struct SalesRollup {
+    const char* table;
+    const char* keyColumns;   // column definitions of the key
+    const char* keyNames;     // key column names, comma separated
+    const char* keyExpr;      // expressions producing the key from a sales row
+};
+
+const SalesRollup salesRollups[] = {
+    { "sales_daily", "day TEXT NOT NULL", "day", "COALESCE(substr($.soldAt, 1, 10), 'undated')" },
+    { "sales_monthly", "month TEXT NOT NULL", "month", "COALESCE(substr($.soldAt, 1, 7), 'undated')" },
+    { "sales_by_category", "type TEXT NOT NULL, setName TEXT NOT NULL", "type, setName", "$.type, $.setName" },
+};
+
+string rollupKey(const SalesRollup& rollup, const char* row) {
+    string expr = rollup.keyExpr;
+    for (size_t pos = expr.find('$'); pos != string::npos; pos = expr.find('$', pos)) {
+        expr.replace(pos, 1, row);
+        pos += strlen(row);
+    }
+    return expr;
+}
+
+// Adds (row "NEW") or removes (row "OLD") one sale from a rollup.
+string rollupApplySql(const SalesRollup& rollup, const char* row, bool add) {
+    string r = row;
+    string keys = rollup.keyNames;
+    if (add) {
+        return "INSERT INTO " + string(rollup.table) + " (" + keys + ", salesCount, cardsSold, revenue, cost, profit) VALUES ("
+            + rollupKey(rollup, row) + ", 1, " + r + ".quantitySold, " + r + ".finalSoldPrice, " + r + ".purchasePrice * " + r + ".quantitySold, " + r + ".profitMade) "
+            "ON CONFLICT(" + keys + ") DO UPDATE SET salesCount = salesCount + 1, cardsSold = cardsSold + excluded.cardsSold, "
+            "revenue = revenue + excluded.revenue, cost = cost + excluded.cost, profit = profit + excluded.profit;";
+    }
+    string match = " WHERE (" + keys + ") = (" + rollupKey(rollup, row) + ")";
+    return "UPDATE " + string(rollup.table) + " SET salesCount = salesCount - 1, cardsSold = cardsSold - " + r + ".quantitySold, "
+        "revenue = revenue - " + r + ".finalSoldPrice, cost = cost - " + r + ".purchasePrice * " + r + ".quantitySold, profit = profit - " + r + ".profitMade"
+        + match + ";DELETE FROM " + rollup.table + match + " AND salesCount <= 0;";
+}
+
+// Sale timestamps plus per-day, per-month and per-type/set rollups that
+// triggers update on every sales insert, delete and update, so period
+// reports read a handful of summary rows instead of scanning every sale.
+// Sales recorded before this version have no date and roll up as 'undated'.
+bool migrateAddSaleRollups(Database& db, string& error) {
+    string sql = "ALTER TABLE sales ADD COLUMN soldAt TEXT;";
+    for (const SalesRollup& rollup : salesRollups) {
+        string t = rollup.table;
+        sql += "CREATE TABLE " + t + " (" + rollup.keyColumns + ", salesCount INTEGER NOT NULL, cardsSold INTEGER NOT NULL, "
+            "revenue REAL NOT NULL, cost REAL NOT NULL, profit REAL NOT NULL, PRIMARY KEY (" + rollup.keyNames + ")) WITHOUT ROWID;";
+        sql += "INSERT INTO " + t + " SELECT " + rollupKey(rollup, "sales") + ", COUNT(*), SUM(quantitySold), SUM(finalSoldPrice), "
+            "SUM(purchasePrice * quantitySold), SUM(profitMade) FROM sales GROUP BY " + rollupKey(rollup, "sales") + ";";
+        sql += "CREATE TRIGGER " + t + "_ai AFTER INSERT ON sales BEGIN " + rollupApplySql(rollup, "NEW", true) + " END;";
+        sql += "CREATE TRIGGER " + t + "_ad AFTER DELETE ON sales BEGIN " + rollupApplySql(rollup, "OLD", false) + " END;";
+        sql += "CREATE TRIGGER " + t + "_au AFTER UPDATE OF soldAt, type, setName, purchasePrice, finalSoldPrice, profitMade, quantitySold ON sales BEGIN "
+            + rollupApplySql(rollup, "OLD", false) + rollupApplySql(rollup, "NEW", true) + " END;";
+    }
+    return execMigrationSql(db, sql.c_str(), error);
+}
+
+// Per-table change counters for the binary snapshots. Every insert, update
+// and delete bumps its table's generation, so a snapshot stamped with the
+// generation it was taken at is checked against the database in one read.
+// Counters start at a random value so that a recreated database never
+// matches a snapshot left over from an earlier one.
+bool migrateAddChangeGenerations(Database& db, string& error) {
+    string sql = "CREATE TABLE change_generation (tableName TEXT PRIMARY KEY, generation INTEGER NOT NULL) WITHOUT ROWID;";
+    for (const char* table : { "inventory", "sales" }) {
+        string t = table;
+        string bump = "UPDATE change_generation SET generation = generation + 1 WHERE tableName = '" + t + "';";
+        sql += "INSERT INTO change_generation VALUES ('" + t + "', abs(random() % 1000000000000));";
+        sql += "CREATE TRIGGER " + t + "_generation_ai AFTER INSERT ON " + t + " BEGIN " + bump + " END;";
+        sql += "CREATE TRIGGER " + t + "_generation_ad AFTER DELETE ON " + t + " BEGIN " + bump + " END;";
+        sql += "CREATE TRIGGER " + t + "_generation_au AFTER UPDATE ON " + t + " BEGIN " + bump + " END;";
+    }
+    return execMigrationSql(db, sql.c_str(), error);
+}
+
+// Recreates table t from definition (its column list), copying every row
+// with copySql, which reads from the old table and inserts into <t>_new. The
+// table's indexes and triggers are recreated from their saved SQL, and ids
+// and the AUTOINCREMENT counter carry over, so the external-content FTS
+// index and anything else keyed on id stays valid.
+bool rebuildTable(Database& db, const string& t, const string& definition, const string& copySql, string& error) {
+    vector<string> dependents;
+    {
+        Statement stmt = db.prepare("SELECT sql FROM sqlite_master WHERE tbl_name = ? AND type IN ('index', 'trigger') AND sql IS NOT NULL;");
+        sqlite3_bind_text(stmt, 1, t.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) dependents.push_back(string((const char*)sqlite3_column_text(stmt, 0)) + ";");
+    }
+    string sql = "CREATE TABLE " + t + "_new (" + definition + ");" + copySql +
+        "DELETE FROM sqlite_sequence WHERE name = '" + t + "_new';"
+        "INSERT INTO sqlite_sequence (name, seq) SELECT '" + t + "_new', seq FROM sqlite_sequence WHERE name = '" + t + "';"
+        "DROP TABLE " + t + ";"
+        "ALTER TABLE " + t + "_new RENAME TO " + t + ";";
+    for (const string& dependent : dependents) sql += dependent;
+    return execMigrationSql(db, sql.c_str(), error);
+}
+
+// Integer cents from a REAL dollar column, for migration 7.
+string centsFrom(const string& column) {
+    return "CAST(round(" + column + " * 100) AS INTEGER)";
+}
+
+// Stores every amount as INTEGER cents instead of REAL dollars (see Money):
+// inventory and sales are rebuilt with INTEGER price columns, the rollups
+// are recreated and refilled from the converted sales so their sums are
+// exact, and dashboard_totals is dropped for initializeDatabase() to
+// recreate and reseed. Rows also get smaller, as a typical price fits a
+// 1-3 byte integer instead of an 8-byte float.
+bool migrateMoneyToCents(Database& db, string& error) {
+    bool ok = rebuildTable(db, "inventory",
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "type TEXT NOT NULL,"
+        "name TEXT NOT NULL,"
+        "setName TEXT NOT NULL,"
+        "cardNumber TEXT,"
+        "condition TEXT,"
+        "purchasePrice INTEGER NOT NULL,"
+        "ebayCompValue INTEGER NOT NULL,"
+        "reference TEXT,"
+        "quantity INTEGER NOT NULL,"
+        "marketValue INTEGER GENERATED ALWAYS AS (ebayCompValue * quantity) VIRTUAL,"
+        "potentialProfit INTEGER GENERATED ALWAYS AS ((ebayCompValue - purchasePrice) * quantity) VIRTUAL",
+        "INSERT INTO inventory_new (id, type, name, setName, cardNumber, condition, purchasePrice, ebayCompValue, reference, quantity) "
+        "SELECT id, type, name, setName, cardNumber, condition, " + centsFrom("purchasePrice") + ", " + centsFrom("ebayCompValue") + ", reference, quantity FROM inventory;",
+        error);
+    ok = ok && rebuildTable(db, "sales",
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "type TEXT NOT NULL,"
+        "name TEXT NOT NULL,"
+        "setName TEXT NOT NULL,"
+        "cardNumber TEXT,"
+        "condition TEXT,"
+        "reference TEXT,"
+        "purchasePrice INTEGER NOT NULL,"
+        "finalSoldPrice INTEGER NOT NULL,"
+        "profitMade INTEGER NOT NULL,"
+        "quantitySold INTEGER NOT NULL,"
+        "soldAt TEXT",
+        "INSERT INTO sales_new (id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold, soldAt) "
+        "SELECT id, type, name, setName, cardNumber, condition, reference, " + centsFrom("purchasePrice") + ", " + centsFrom("finalSoldPrice") + ", "
+        + centsFrom("profitMade") + ", quantitySold, soldAt FROM sales;",
+        error);
+    if (!ok) return false;
+
+    string sql;
+    for (const SalesRollup& rollup : salesRollups) {
+        string t = rollup.table;
+        sql += "DROP TABLE " + t + ";";
+        sql += "CREATE TABLE " + t + " (" + rollup.keyColumns + ", salesCount INTEGER NOT NULL, cardsSold INTEGER NOT NULL, "
+            "revenue INTEGER NOT NULL, cost INTEGER NOT NULL, profit INTEGER NOT NULL, PRIMARY KEY (" + rollup.keyNames + ")) WITHOUT ROWID;";
+        sql += "INSERT INTO " + t + " SELECT " + rollupKey(rollup, "sales") + ", COUNT(*), SUM(quantitySold), SUM(finalSoldPrice), "
+            "SUM(purchasePrice * quantitySold), SUM(profitMade) FROM sales GROUP BY " + rollupKey(rollup, "sales") + ";";
+    }
+    sql += "DROP TABLE IF EXISTS dashboard_totals;";
+    return execMigrationSql(db, sql.c_str(), error);
+}
+
+const Migration migrations[] = {
+    { 1, "repair sales table columns", migrateRepairSalesTable },
+    { 2, "add lookup and sort indexes", migrateAddLookupIndexes },
+    { 3, "add indexed market value and potential profit columns", migrateAddValueColumns },
+    { 4, "add type index for paged listings", migrateAddTypeIndex },
+    { 5, "add sale timestamps and period rollups", migrateAddSaleRollups },
+    { 6, "add change generations for binary snapshots", migrateAddChangeGenerations },
+    { 7, "store amounts as integer cents", migrateMoneyToCents },
+};
+
+int schemaVersion(Database& db) {
+    Statement stmt = db.prepare("PRAGMA user_version;");
+    return sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+}
+
+// Applies every migration newer than the file's user_version, each in its
+// own transaction together with its version bump. Stops at the first failure
+// so a later step never runs against a half-upgraded schema, and returns
+// false unless the file ends up at the latest version.
+bool runMigrations(Database& db) {
+    int current = schemaVersion(db);
+    for (const Migration& m : migrations) {
+        if (m.version <= current) continue;
+
+        // If BEGIN fails (another writer held the lock past the busy
+        // timeout), the steps must not run: each would autocommit alone.
+        string error;
+        bool ok = execMigrationSql(db, "BEGIN IMMEDIATE;", error);
+        if (!ok) {
+            cerr << "Schema migration " << m.version << " (" << m.description << ") could not start: " << error << endl;
+            return false;
+        }
+        ok = m.apply(db, error);
+        if (ok) {
+            string bump = "PRAGMA user_version = " + to_string(m.version) + ";";
+            ok = execMigrationSql(db, bump.c_str(), error);
+        }
+        ok = ok && execMigrationSql(db, "COMMIT;", error);
+        if (!ok) {
+            sqlite3_exec(db.handle(), "ROLLBACK;", 0, 0, 0);
+            cerr << "Schema migration " << m.version << " (" << m.description << ") failed: " << error << endl;
+            return false;
+        }
+        current = m.version;
+    }
+    return true;
+}
+
+// Full-text indexes over the searchable text columns of inventory and sales.
+// They are external-content FTS5 tables (no second copy of the text) kept in
+// sync by triggers, and are rebuilt from the base table the first time they
+// are created. If this SQLite build lacks FTS5 the searches fall back to LIKE.
+void initializeSearchIndex(Database& db) {
+    const char* tables[] = { "inventory", "sales" };
+    for (const char* table : tables) {
+        string t = table;
+        string fts = t + "_fts";
+
+        if (tableExists(db, fts.c_str())) continue;
+
+        string sql =
+            "CREATE VIRTUAL TABLE " + fts + " USING fts5(name, setName, reference, type,"
+            "content='" + t + "', content_rowid='id', prefix='2 3');"
+            "CREATE TRIGGER IF NOT EXISTS " + fts + "_ai AFTER INSERT ON " + t + " BEGIN "
+            "INSERT INTO " + fts + "(rowid, name, setName, reference, type) VALUES (NEW.id, NEW.name, NEW.setName, NEW.reference, NEW.type); END;"
+            "CREATE TRIGGER IF NOT EXISTS " + fts + "_ad AFTER DELETE ON " + t + " BEGIN "
+            "INSERT INTO " + fts + "(" + fts + ", rowid, name, setName, reference, type) VALUES ('delete', OLD.id, OLD.name, OLD.setName, OLD.reference, OLD.type); END;"
+            "CREATE TRIGGER IF NOT EXISTS " + fts + "_au AFTER UPDATE OF name, setName, reference, type ON " + t + " BEGIN "
+            "INSERT INTO " + fts + "(" + fts + ", rowid, name, setName, reference, type) VALUES ('delete', OLD.id, OLD.name, OLD.setName, OLD.reference, OLD.type);"
+            "INSERT INTO " + fts + "(rowid, name, setName, reference, type) VALUES (NEW.id, NEW.name, NEW.setName, NEW.reference, NEW.type); END;"
+            "INSERT INTO " + fts + "(" + fts + ") VALUES ('rebuild');";
+
+        char* zErrMsg = 0;
+        sqlite3_exec(db.handle(), "SAVEPOINT search_index;", 0, 0, 0);
+        if (sqlite3_exec(db.handle(), sql.c_str(), 0, 0, &zErrMsg) != SQLITE_OK) {
+            cerr << "Full-text search unavailable for " << t << ": " << zErrMsg << endl;
+            sqlite3_free(zErrMsg);
+            sqlite3_exec(db.handle(), "ROLLBACK TO search_index;", 0, 0, 0);
+        }
+        sqlite3_exec(db.handle(), "RELEASE search_index;", 0, 0, 0);
+    }
+}
+
+bool tableExists(Database& db, const char* name) {
+    Statement stmt = db.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;");
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_TRANSIENT);
+    return sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+// Turns free text typed at a search prompt into an FTS5 query against one
+// column: every word becomes a quoted prefix term ("char"* "holo"*), so user
+// input can never be parsed as FTS syntax. Returns "" if there are no words.
+string buildFtsQuery(const string& column, const string& term) {
+    string terms;
+    stringstream words(term);
+    string word;
+    while (words >> word) {
+        if (!terms.empty()) terms += " ";
+        terms += "\"";
+        for (char c : word) {
+            if (c == '"') terms += "\"\"";
+            else terms += c;
+        }
+        terms += "\"*";
+    }
+    if (terms.empty()) return "";
+    return column + " : (" + terms + ")";
+}
+
+// Column text as a view into the current row; NULL reads as empty.
+string_view columnView(sqlite3_stmt* stmt, int col) {
+    const char* text = (const char*)sqlite3_column_text(stmt, col);
+    return text ? string_view(text, sqlite3_column_bytes(stmt, col)) : string_view();
+}
+
+// Price column (INTEGER cents) of the current row; NULL reads as zero.
+Money columnMoney(sqlite3_stmt* stmt, int col) {
+    return Money::fromCents(sqlite3_column_int64(stmt, col));
+}
+
+string_view storeColumn(StringArena& arena, sqlite3_stmt* stmt, int col) {
+    string_view text = columnView(stmt, col);
+    return arena.store(text.data(), text.size());
+}
+
+// ===================================================================
+// BINARY SNAPSHOTS
+// ===================================================================
+// The loaded inventory and sales models are also kept on disk next to the
+// database (<db>-inventory.snap, <db>-sales.snap) as fixed-width columns
+// plus a string heap. A snapshot is stamped with the schema version and the
+// table's change generation, and opening one whose stamp still matches maps
+// it instead of stepping every row through SQLite: the rows' text points
+// straight into the mapping.
+
+// Column order of each snapshot, matching CardRow and SaleRow.
+const vector<uint32_t> inventorySnapshotColumns = { Int32Column, DictionaryColumn, TextColumn, DictionaryColumn,
+    TextColumn, DictionaryColumn, TextColumn, Int64Column, Int64Column, Int32Column };
+const vector<uint32_t> salesSnapshotColumns = { Int32Column, DictionaryColumn, TextColumn, DictionaryColumn,
+    TextColumn, DictionaryColumn, TextColumn, Int64Column, Int64Column, Int64Column, Int32Column };
+
+// Schema version and change generation of a table; invalid if the
+// change_generation table is missing.
+SnapshotStamp readSnapshotStamp(Database& db, const char* table) {
+    SnapshotStamp stamp;
+    Statement stmt = db.prepare("SELECT generation FROM change_generation WHERE tableName = ?;");
+    if (!stmt) return stamp;
+    sqlite3_bind_text(stmt, 1, table, -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        stamp.generation = sqlite3_column_int64(stmt, 0);
+        stamp.userVersion = schemaVersion(db);
     }
+    return stamp;
+}
+
+// Snapshot file beside the database, like its -wal file; "" for in-memory
+// and temporary databases, which get no snapshot.
+string snapshotPath(Database& db, const char* table) {
+    const char* file = sqlite3_db_filename(db.handle(), "main");
+    if (!file || !*file) return "";
+    return string(file) + "-" + table + ".snap";
+}
+
+// Interns a snapshot's dictionary into pool; entry i becomes id ids[i].
+vector<uint32_t> internSnapshotDictionary(const SnapshotReader& snap, StringPool& pool) {
+    vector<uint32_t> ids(snap.dictionarySize());
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = pool.intern(snap.dictionaryEntry(i));
+    return ids;
+}
+
+bool writeInventorySnapshot(const InventoryModel& inventory, const string& path) {
+    const vector<CardRow>& rows = inventory.rows;
+    SnapshotWriter writer(rows.size());
+    writer.dictionary(inventory.dictionary);
+    writer.int32Column([&](size_t i) { return rows[i].id; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].type; });
+    writer.textColumn([&](size_t i) { return rows[i].name; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].setName; });
+    writer.textColumn([&](size_t i) { return rows[i].cardNumber; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].condition; });
+    writer.textColumn([&](size_t i) { return rows[i].reference; });
+    writer.int64Column([&](size_t i) { return rows[i].purchasePrice.cents; });
+    writer.int64Column([&](size_t i) { return rows[i].ebayCompValue.cents; });
+    writer.int32Column([&](size_t i) { return rows[i].quantity; });
+    return writer.save(path, inventory.stamp);
+}
+
+bool writeSalesSnapshot(const SalesModel& sales, const string& path) {
+    const vector<SaleRow>& rows = sales.rows;
+    SnapshotWriter writer(rows.size());
+    writer.dictionary(sales.dictionary);
+    writer.int32Column([&](size_t i) { return rows[i].id; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].type; });
+    writer.textColumn([&](size_t i) { return rows[i].name; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].setName; });
+    writer.textColumn([&](size_t i) { return rows[i].cardNumber; });
+    writer.dictionaryColumn([&](size_t i) { return rows[i].condition; });
+    writer.textColumn([&](size_t i) { return rows[i].reference; });
+    writer.int64Column([&](size_t i) { return rows[i].purchasePrice.cents; });
+    writer.int64Column([&](size_t i) { return rows[i].finalSoldPrice.cents; });
+    writer.int64Column([&](size_t i) { return rows[i].profitMade.cents; });
+    writer.int32Column([&](size_t i) { return rows[i].quantitySold; });
+    return writer.save(path, sales.stamp);
 }
 
-void loadInventory(vector<CardCollection>& inventory, sqlite3* db) {
+// Replaces inventory with the snapshot at path if it was taken at stamp.
+// Leaves inventory empty and returns false if the file is unusable.
+bool openInventorySnapshot(InventoryModel& inventory, const string& path, const SnapshotStamp& stamp) {
+    SnapshotReader snap;
+    if (path.empty() || !snap.open(path, stamp, inventorySnapshotColumns)) return false;
     inventory.clear();
-    const char* sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory;";
-    sqlite3_stmt* stmt;
+    vector<uint32_t> ids = internSnapshotDictionary(snap, inventory.dictionary);
+    const int32_t* id = snap.int32Column(0);
+    const uint32_t* type = snap.dictionaryColumn(1);
+    const SnapshotText* name = snap.textColumn(2);
+    const uint32_t* setName = snap.dictionaryColumn(3);
+    const SnapshotText* cardNumber = snap.textColumn(4);
+    const uint32_t* condition = snap.dictionaryColumn(5);
+    const SnapshotText* reference = snap.textColumn(6);
+    const int64_t* purchasePrice = snap.int64Column(7);
+    const int64_t* ebayCompValue = snap.int64Column(8);
+    const int32_t* quantity = snap.int32Column(9);
+
+    inventory.rows.resize(snap.rows());
+    for (size_t i = 0; i < snap.rows(); ++i) {
+        if (type[i] >= ids.size() || setName[i] >= ids.size() || condition[i] >= ids.size()) {
+            inventory.clear();
+            return false;
+        }
+        CardRow& row = inventory.rows[i];
+        row.id = id[i];
+        row.type = ids[type[i]];
+        row.name = snap.text(name[i]);
+        row.setName = ids[setName[i]];
+        row.cardNumber = snap.text(cardNumber[i]);
+        row.condition = ids[condition[i]];
+        row.reference = snap.text(reference[i]);
+        row.purchasePrice = Money::fromCents(purchasePrice[i]);
+        row.ebayCompValue = Money::fromCents(ebayCompValue[i]);
+        row.quantity = quantity[i];
+    }
+    inventory.mapping = snap.release();
+    inventory.stamp = stamp;
+    return true;
+}
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            CardCollection newCard;
-            newCard.id = sqlite3_column_int(stmt, 0);
-            newCard.type = (const char*)sqlite3_column_text(stmt, 1);
-            newCard.name = (const char*)sqlite3_column_text(stmt, 2);
-            newCard.setName = (const char*)sqlite3_column_text(stmt, 3);
-            newCard.cardNumber = (const char*)sqlite3_column_text(stmt, 4);
-            newCard.condition = (const char*)sqlite3_column_text(stmt, 5);
-            newCard.reference = (const char*)sqlite3_column_text(stmt, 6);
-            newCard.purchasePrice = sqlite3_column_double(stmt, 7);
-            newCard.ebayCompValue = sqlite3_column_double(stmt, 8);
-            newCard.quantity = sqlite3_column_int(stmt, 9);
-            inventory.push_back(newCard);
+bool openSalesSnapshot(SalesModel& sales, const string& path, const SnapshotStamp& stamp) {
+    SnapshotReader snap;
+    if (path.empty() || !snap.open(path, stamp, salesSnapshotColumns)) return false;
+    sales.clear();
+    vector<uint32_t> ids = internSnapshotDictionary(snap, sales.dictionary);
+    const int32_t* id = snap.int32Column(0);
+    const uint32_t* type = snap.dictionaryColumn(1);
+    const SnapshotText* name = snap.textColumn(2);
+    const uint32_t* setName = snap.dictionaryColumn(3);
+    const SnapshotText* cardNumber = snap.textColumn(4);
+    const uint32_t* condition = snap.dictionaryColumn(5);
+    const SnapshotText* reference = snap.textColumn(6);
+    const int64_t* purchasePrice = snap.int64Column(7);
+    const int64_t* finalSoldPrice = snap.int64Column(8);
+    const int64_t* profitMade = snap.int64Column(9);
+    const int32_t* quantitySold = snap.int32Column(10);
+
+    sales.rows.resize(snap.rows());
+    for (size_t i = 0; i < snap.rows(); ++i) {
+        if (type[i] >= ids.size() || setName[i] >= ids.size() || condition[i] >= ids.size()) {
+            sales.clear();
+            return false;
+        }
+        SaleRow& row = sales.rows[i];
+        row.id = id[i];
+        row.type = ids[type[i]];
+        row.name = snap.text(name[i]);
+        row.setName = ids[setName[i]];
+        row.cardNumber = snap.text(cardNumber[i]);
+        row.condition = ids[condition[i]];
+        row.reference = snap.text(reference[i]);
+        row.purchasePrice = Money::fromCents(purchasePrice[i]);
+        row.finalSoldPrice = Money::fromCents(finalSoldPrice[i]);
+        row.profitMade = Money::fromCents(profitMade[i]);
+        row.quantitySold = quantitySold[i];
+    }
+    sales.mapping = snap.release();
+    sales.stamp = stamp;
+    return true;
+}
+
+// On exit, writes the snapshot of any model that was patched since it was
+// last read or written, so the next start maps it instead of reading SQL.
+void saveSnapshots(Database& db, InventoryModel& inventory, SalesModel& sales) {
+    if (inventory.patched) {
+        loadInventory(inventory, db);
+        if (inventory.patched && writeInventorySnapshot(inventory, snapshotPath(db, "inventory"))) inventory.patched = false;
+    }
+    if (sales.patched) {
+        loadSalesLog(sales, db);
+        if (sales.patched && writeSalesSnapshot(sales, snapshotPath(db, "sales"))) sales.patched = false;
+    }
+}
+
+// Re-reads the rows with the given ids into a model ordered by id. Changed
+// rows are overwritten in place, new ones inserted at their position (in
+// practice appended, as ids only grow) and deleted ones dropped, so each id
+// costs one primary-key lookup and one binary search. sql selects one row
+// by id in the column order readRow expects.
+// The model's name index, if built, is updated for the same rows.
+template <typename Model, typename ReadRow>
+void patchRows(Model& model, Database& db, const char* sql, const unordered_set<sqlite3_int64>& rowids, ReadRow readRow) {
+    vector<sqlite3_int64> ids(rowids.begin(), rowids.end());
+    sort(ids.begin(), ids.end());
+    auto& rows = model.rows;
+    bool removed = false;
+    Statement stmt = db.prepare(sql);
+    for (sqlite3_int64 id : ids) {
+        auto it = lower_bound(rows.begin(), rows.end(), id, [](const auto& row, sqlite3_int64 key) { return row.id < key; });
+        bool present = it != rows.end() && it->id == id;
+        sqlite3_reset(stmt);
+        sqlite3_bind_int64(stmt, 1, id);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto row = readRow(model, stmt);
+            if (model.names.built()) {
+                if (present) model.names.remove(it->name, it->id);
+                model.names.add(row.name, row.id);
+            }
+            if (present) *it = row;
+            else rows.insert(it, row);
+        }
+        else if (present) {
+            if (model.names.built()) model.names.remove(it->name, it->id);
+            it->id = -1;
+            removed = true;
+        }
+    }
+    if (removed) rows.erase(remove_if(rows.begin(), rows.end(), [](const auto& row) { return row.id == -1; }), rows.end());
+}
+
+CardRow readCardRow(InventoryModel& inventory, sqlite3_stmt* stmt) {
+    CardRow newCard;
+    newCard.id = sqlite3_column_int(stmt, 0);
+    newCard.type = inventory.dictionary.intern(columnView(stmt, 1));
+    newCard.name = storeColumn(inventory.text, stmt, 2);
+    newCard.setName = inventory.dictionary.intern(columnView(stmt, 3));
+    newCard.cardNumber = storeColumn(inventory.text, stmt, 4);
+    newCard.condition = inventory.dictionary.intern(columnView(stmt, 5));
+    newCard.reference = storeColumn(inventory.text, stmt, 6);
+    newCard.purchasePrice = columnMoney(stmt, 7);
+    newCard.ebayCompValue = columnMoney(stmt, 8);
+    newCard.quantity = sqlite3_column_int(stmt, 9);
+    return newCard;
+}
+
+SaleRow readSaleRow(SalesModel& sales, sqlite3_stmt* stmt) {
+    SaleRow newSale;
+    newSale.id = sqlite3_column_int(stmt, 0);
+    newSale.type = sales.dictionary.intern(columnView(stmt, 1));
+    newSale.name = storeColumn(sales.text, stmt, 2);
+    newSale.setName = sales.dictionary.intern(columnView(stmt, 3));
+    newSale.cardNumber = storeColumn(sales.text, stmt, 4);
+    newSale.condition = sales.dictionary.intern(columnView(stmt, 5));
+    newSale.reference = storeColumn(sales.text, stmt, 6);
+    newSale.purchasePrice = columnMoney(stmt, 7);
+    newSale.finalSoldPrice = columnMoney(stmt, 8);
+    newSale.profitMade = columnMoney(stmt, 9);
+    newSale.quantitySold = sqlite3_column_int(stmt, 10);
+    return newSale;
+}
+
+// Brings inventory in line with the database, doing as little as it can:
+// nothing if it already reflects the table's current generation; re-reading
+// only the rows this program changed since, if those account for every
+// change; mapping the binary snapshot if that is current; and only otherwise
+// reading every row through SQL (writing a fresh snapshot for next time).
+void loadInventory(InventoryModel& inventory, Database& db) {
+    ProfileScope scope(profiler, "loadInventory");
+    string path = snapshotPath(db, "inventory");
+    // Stamp and rows from one read transaction, so they agree.
+    execCached(db, "BEGIN;");
+    SnapshotStamp stamp = readSnapshotStamp(db, "inventory");
+    ChangeCapture::Changes changes = changeCapture.take("inventory");
+    bool fromSql = false;
+    if (!(inventory.stamp == stamp)) {
+        if (changes.cover(inventory.stamp, stamp)) {
+            patchRows(inventory, db, "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory WHERE id = ?;",
+                changes.rowids, readCardRow);
+            inventory.stamp = stamp;
+            inventory.patched = true;
+        }
+        else if (!openInventorySnapshot(inventory, path, stamp)) {
+            readInventoryRows(inventory, db);
+            inventory.stamp = stamp;
+            fromSql = true;
+        }
+    }
+    execCached(db, "COMMIT;");
+    if (fromSql && !path.empty()) writeInventorySnapshot(inventory, path);
+}
+
+void readInventoryRows(InventoryModel& inventory, Database& db) {
+    inventory.clear();
+    const char* sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory ORDER BY id;";
+    Statement stmt = db.prepare(sql);
+
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) inventory.rows.push_back(readCardRow(inventory, stmt));
+    }
+}
+
+// Same as loadInventory(), for the sales log.
+void loadSalesLog(SalesModel& sales, Database& db) {
+    ProfileScope scope(profiler, "loadSalesLog");
+    string path = snapshotPath(db, "sales");
+    execCached(db, "BEGIN;");
+    SnapshotStamp stamp = readSnapshotStamp(db, "sales");
+    ChangeCapture::Changes changes = changeCapture.take("sales");
+    bool fromSql = false;
+    if (!(sales.stamp == stamp)) {
+        if (changes.cover(sales.stamp, stamp)) {
+            patchRows(sales, db, "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold FROM sales WHERE id = ?;",
+                changes.rowids, readSaleRow);
+            sales.stamp = stamp;
+            sales.patched = true;
+        }
+        else if (!openSalesSnapshot(sales, path, stamp)) {
+            readSalesRows(sales, db);
+            sales.stamp = stamp;
+            fromSql = true;
         }
     }
-    sqlite3_finalize(stmt);
+    execCached(db, "COMMIT;");
+    if (fromSql && !path.empty()) writeSalesSnapshot(sales, path);
 }
 
-void loadSalesLog(vector<soldCard>& sales, sqlite3* db) {
+void readSalesRows(SalesModel& sales, Database& db) {
     sales.clear();
-    const char* sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold FROM sales;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+    const char* sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold FROM sales ORDER BY id;";
+    Statement stmt = db.prepare(sql);
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) sales.rows.push_back(readSaleRow(sales, stmt));
+    }
+}
+
+// Reloads the numeric column snapshot, but only if a write has happened on
+// this connection (total_changes) or another one (data_version) since it
+// was last read. Only the numeric columns are read, into dense arrays.
+void refreshSnapshot(Database& db, ColumnSnapshot& snapshot) {
+    int64_t changes = sqlite3_total_changes64(db.handle());
+    int dataVersion = 0;
+    {
+        Statement stmt = db.prepare("PRAGMA data_version;");
+        if (sqlite3_step(stmt) == SQLITE_ROW) dataVersion = sqlite3_column_int(stmt, 0);
+    }
+    if (snapshot.loaded && snapshot.source == db.handle() && snapshot.changeStamp == changes && snapshot.dataVersion == dataVersion) return;
+
+    // Both tables from one read transaction, so the totals agree even if a
+    // sale is recorded on another connection between the two scans.
+    execCached(db, "BEGIN;");
+    InventoryColumns& inv = snapshot.inventory;
+    inv.purchasePrice.clear(); inv.ebayCompValue.clear(); inv.quantity.clear();
+    {
+        Statement stmt = db.prepare("SELECT purchasePrice, ebayCompValue, quantity FROM inventory;");
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            soldCard newSale;
-            newSale.id = sqlite3_column_int(stmt, 0);
-            newSale.type = (const char*)sqlite3_column_text(stmt, 1);
-            newSale.name = (const char*)sqlite3_column_text(stmt, 2);
-            newSale.setName = (const char*)sqlite3_column_text(stmt, 3);
-            newSale.cardNumber = (const char*)sqlite3_column_text(stmt, 4);
-            newSale.condition = (const char*)sqlite3_column_text(stmt, 5);
-            newSale.reference = (const char*)sqlite3_column_text(stmt, 5);
-            newSale.purchasePrice = sqlite3_column_double(stmt, 6);
-            newSale.finalSoldPrice = sqlite3_column_double(stmt, 7);
-            newSale.profitMade = sqlite3_column_double(stmt, 8);
-            newSale.quantitySold = sqlite3_column_int(stmt, 9);
-            sales.push_back(newSale);
+            inv.purchasePrice.push_back(sqlite3_column_int64(stmt, 0));
+            inv.ebayCompValue.push_back(sqlite3_column_int64(stmt, 1));
+            inv.quantity.push_back(sqlite3_column_int(stmt, 2));
+        }
+    }
+
+    SalesColumns& sold = snapshot.sales;
+    sold.finalSoldPrice.clear(); sold.profitMade.clear(); sold.quantitySold.clear();
+    {
+        Statement stmt = db.prepare("SELECT finalSoldPrice, profitMade, quantitySold FROM sales;");
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            sold.finalSoldPrice.push_back(sqlite3_column_int64(stmt, 0));
+            sold.profitMade.push_back(sqlite3_column_int64(stmt, 1));
+            sold.quantitySold.push_back(sqlite3_column_int(stmt, 2));
+        }
+    }
+
+    execCached(db, "COMMIT;");
+
+    snapshot.loaded = true;
+    snapshot.source = db.handle();
+    snapshot.changeStamp = changes;
+    snapshot.dataVersion = dataVersion;
+}
+
+// ===================================================================
+// TYPE-AHEAD PICKER
+// ===================================================================
+
+// Indexes the model's names on first use. Afterwards patchRows keeps the
+// index current, so this only runs again after a full reload.
+template <typename Model>
+void buildNameIndex(Model& model) {
+    if (model.names.built()) return;
+    ProfileScope scope(profiler, "buildNameIndex");
+    model.names.build(model.rows);
+}
+
+// Rows of the names best matching query, in match order, at most limit of
+// them. Each row is found by id with a binary search; nothing here scans
+// the model.
+template <typename Model>
+vector<size_t> pickCandidates(Model& model, const string& query, size_t limit) {
+    buildNameIndex(model);
+    vector<size_t> candidates;
+    for (const NameIndex::Match& match : model.names.search(query, limit)) {
+        for (int id : model.names.ids(match.name)) {
+            auto it = lower_bound(model.rows.begin(), model.rows.end(), id, [](const auto& row, int key) { return row.id < key; });
+            if (it == model.rows.end() || it->id != id) continue;
+            candidates.push_back(it - model.rows.begin());
+            if (candidates.size() == limit) return candidates;
+        }
+    }
+    return candidates;
+}
+
+// Lets the user find one row of model by typing part of its name, instead
+// of listing every row. On a console the matches narrow with each keystroke
+// (Up/Down or Tab to move, Enter to pick, Esc or Ctrl+C to cancel). With
+// piped input a search line is read and its matches numbered instead.
+// describe(out, row) writes a row's one-line summary. Returns the row's
+// index in model.rows, or -1 if nothing was picked.
+template <typename Model, typename Describe>
+int pickRow(Model& model, const char* prompt, Describe describe) {
+    const size_t shown = 10;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n'); // rest of the menu line
+
+    if (!KeyReader::available()) {
+        string line;
+        cout << prompt;
+        if (!getline(cin, line)) return -1;
+        vector<size_t> candidates;
+        while (!(line = trim(line)).empty()) {
+            if (!candidates.empty() && line.size() < 10 && all_of(line.begin(), line.end(), [](unsigned char c) { return isdigit(c); })) {
+                size_t choice = stoul(line);
+                if (choice >= 1 && choice <= candidates.size()) return (int)candidates[choice - 1];
+            }
+            candidates = pickCandidates(model, line, shown);
+            PageWriter out;
+            if (candidates.empty()) out << "No matches for '" << line << "'. Search again (or nothing to cancel): ";
+            else {
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    out << "  " << (int)(i + 1) << ". ";
+                    describe(out, model.rows[candidates[i]]);
+                    out << "\n";
+                }
+                out << "Enter a number to pick, more of the name to search again, or nothing to cancel: ";
+            }
+            out.flush();
+            if (!getline(cin, line)) return -1;
+        }
+        return -1;
+    }
+
+    // Up to this many matches can be scrolled through, so a name held by
+    // many rows (the same card in several sets or conditions) stays usable.
+    const size_t limit = 200;
+    KeyReader keys;
+    const size_t width = (size_t)max(20, KeyReader::columns() - 1);
+    string query;
+    vector<size_t> candidates;
+    size_t selected = 0;
+    double searchMs = 0;
+    int picked = -1;
+    PageWriter out, line;
+    while (true) {
+        // Redraw the prompt and the visible matches below it, then put the
+        // cursor back at the end of the typed text.
+        out << "\r\x1b[J" << prompt << query;
+        int lines = 0;
+        size_t first = selected < shown ? 0 : selected - shown + 1;
+        for (size_t i = first; i < candidates.size() && i < first + shown; ++i) {
+            line.clear();
+            line << (i == selected ? "> " : "  ");
+            describe(line, model.rows[candidates[i]]);
+            out << "\n" << line.view().substr(0, width);
+            lines++;
+        }
+        if (!query.empty()) {
+            char status[128];
+            snprintf(status, sizeof(status), "  %zu%s match%s in %.2f ms. Up/Down to move, Enter to pick, Esc to cancel.",
+                candidates.size(), candidates.size() == limit ? "+" : "", candidates.size() == 1 ? "" : "es", searchMs);
+            out << "\n" << string_view(status).substr(0, width);
+            lines++;
+        }
+        if (lines > 0) out << "\x1b[" << lines << "A";
+        out << "\r";
+        size_t column = strlen(prompt) + query.size();
+        if (column > 0) out << "\x1b[" << (int)column << "C";
+        out.flush();
+
+        KeyPress key = keys.read();
+        if (key.kind == KeyPress::Cancel) break;
+        if (key.kind == KeyPress::Enter) {
+            if (candidates.empty()) continue;
+            picked = (int)candidates[selected];
+            break;
+        }
+        if (key.kind == KeyPress::Up && selected > 0) selected--;
+        else if (key.kind == KeyPress::Down && selected + 1 < candidates.size()) selected++;
+        else if (key.kind == KeyPress::Char || (key.kind == KeyPress::Backspace && !query.empty())) {
+            if (key.kind == KeyPress::Char) query += key.ch;
+            else {
+                // Drop a whole UTF-8 character, not just its last byte.
+                while (query.size() > 1 && (static_cast<unsigned char>(query.back()) & 0xC0) == 0x80) query.pop_back();
+                query.pop_back();
+            }
+            auto start = chrono::steady_clock::now();
+            candidates = pickCandidates(model, query, limit);
+            searchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            selected = 0;
         }
     }
-    sqlite3_finalize(stmt);
+    out << "\r\x1b[J" << prompt;
+    if (picked >= 0) describe(out, model.rows[picked]);
+    out << "\n";
+    out.flush();
+    return picked;
 }
 
 // ===================================================================
 // CORE FEATURE FUNCTIONS
 // ===================================================================
 
-void showDashboard(const vector<CardCollection>& inventory, const vector<soldCard>& salesLog) {
+void showDashboard(Database& db) {
     cout << "\n--- Your Dashboard ---\n";
     int totCards = 0;
-    double totMarketValue = 0.0;
+    Money totMarketValue;
     int totSoldCards = 0;
-    double totSaleValue = 0.0;
-    double totNetProfit = 0.0;
+    Money totSaleValue;
+    Money totNetProfit;
 
-    for (const auto& card : inventory) {
-        totCards += card.quantity;
-        totMarketValue += (card.ebayCompValue * card.quantity);
-    }
-    for (const auto& sold : salesLog) {
-        totSoldCards += sold.quantitySold;
-        totSaleValue += sold.finalSoldPrice;
-        totNetProfit += sold.profitMade;
+    // One-row lookup against the trigger-maintained totals; cost does not grow with the tables.
+    const char* sql = "SELECT totCards, totMarketValue, totSoldCards, totSaleValue, totNetProfit FROM dashboard_totals WHERE id = 1;";
+    Statement stmt = db.prepare(sql);
+    if (stmt) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            totCards = sqlite3_column_int(stmt, 0);
+            totMarketValue = columnMoney(stmt, 1);
+            totSoldCards = sqlite3_column_int(stmt, 2);
+            totSaleValue = columnMoney(stmt, 3);
+            totNetProfit = columnMoney(stmt, 4);
+        }
     }
 
     cout << fixed << setprecision(2);
@@ -277,7 +1407,7 @@ void showDashboard(const vector<CardCollection>& inventory, const vector<soldCar
     cout << "----------------------------------\n";
 }
 
-void addCard(sqlite3* db) {
+void addCard(Database& db) {
     CardCollection newCard;
     cout << "\n--- Add a new card ---\n";
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -287,9 +1417,8 @@ void addCard(sqlite3* db) {
     cout << "Condition: "; getline(cin, newCard.condition); newCard.condition = trim(newCard.condition);
     cout << "Reference #: "; getline(cin, newCard.reference); newCard.reference = trim(newCard.reference);
 
-    sqlite3_stmt* stmt;
     const char* sql_check = "SELECT id, quantity FROM inventory WHERE type = ? AND name = ? AND setName = ? AND condition = ? AND reference = ?;";
-    sqlite3_prepare_v2(db, sql_check, -1, &stmt, NULL);
+    Statement stmt = db.prepare(sql_check);
     sqlite3_bind_text(stmt, 1, newCard.type.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 2, newCard.name.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 3, newCard.setName.c_str(), -1, SQLITE_TRANSIENT);
@@ -299,7 +1428,6 @@ void addCard(sqlite3* db) {
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         int existing_id = sqlite3_column_int(stmt, 0);
         int existing_quantity = sqlite3_column_int(stmt, 1);
-        sqlite3_finalize(stmt);
 
         cout << "\nThis card already exists in your inventory.\n";
         int quantityToAdd = 0;
@@ -313,68 +1441,183 @@ void addCard(sqlite3* db) {
 
         int new_quantity = existing_quantity + quantityToAdd;
         const char* sql_update = "UPDATE inventory SET quantity = ? WHERE id = ?;";
-        sqlite3_prepare_v2(db, sql_update, -1, &stmt, NULL);
+        stmt = db.prepare(sql_update);
         sqlite3_bind_int(stmt, 1, new_quantity);
         sqlite3_bind_int(stmt, 2, existing_id);
         if (sqlite3_step(stmt) != SQLITE_DONE) {
-            cerr << "Error updating card: " << sqlite3_errmsg(db) << endl;
+            cerr << "Error updating card: " << sqlite3_errmsg(db.handle()) << endl;
         }
         else {
             cout << "Quantity updated. New total: " << new_quantity << "\n";
         }
-        sqlite3_finalize(stmt);
     }
     else {
-        sqlite3_finalize(stmt);
         cout << "This is a new card. Please provide remaining details.\n";
         cout << "Number: "; getline(cin, newCard.cardNumber); newCard.cardNumber = trim(newCard.cardNumber);
         while (true) { cout << "Quantity: "; cin >> newCard.quantity; if (!cin.fail() && newCard.quantity > 0) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; }
         while (true) { cout << "Price Paid: $"; cin >> newCard.purchasePrice; if (!cin.fail()) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; }
         while (true) { cout << "Ebay Comp Value: $"; cin >> newCard.ebayCompValue; if (!cin.fail()) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; }
 
-        const char* sql_insert = "INSERT INTO inventory (type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity) VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
-        sqlite3_prepare_v2(db, sql_insert, -1, &stmt, NULL);
+        const char* sql_insert = "INSERT INTO inventory (type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
+        stmt = db.prepare(sql_insert);
         sqlite3_bind_text(stmt, 1, newCard.type.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 2, newCard.name.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 3, newCard.setName.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 4, newCard.cardNumber.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 5, newCard.condition.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 6, newCard.reference.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_double(stmt, 7, newCard.purchasePrice);
-        sqlite3_bind_double(stmt, 8, newCard.ebayCompValue);
+        sqlite3_bind_int64(stmt, 7, newCard.purchasePrice.cents);
+        sqlite3_bind_int64(stmt, 8, newCard.ebayCompValue.cents);
         sqlite3_bind_int(stmt, 9, newCard.quantity);
 
         if (sqlite3_step(stmt) != SQLITE_DONE) {
-            cerr << "Error inserting card: " << sqlite3_errmsg(db) << endl;
+            cerr << "Error inserting card: " << sqlite3_errmsg(db.handle()) << endl;
         }
         else {
             cout << "You have now successfully added " << newCard.name << " to your inventory\n";
         }
-        sqlite3_finalize(stmt);
     }
 }
 
-void editCard(vector<CardCollection>& inventory, sqlite3* db) {
+// Writes the sales row for quantity copies of card sold at pricePerCard and
+// takes them out of inventory (deleting the row when none are left).
+bool recordSale(Database& db, const CardCollection& card, int quantity, Money pricePerCard, sqlite3_int64* saleId) {
+    const char* sql_insert = "INSERT INTO sales (type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold, soldAt) VALUES (?,?,?,?,?,?,?,?,?,?, datetime('now', 'localtime'));";
+    Statement stmt = db.prepare(sql_insert);
+    sqlite3_bind_text(stmt, 1, card.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, card.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 3, card.setName.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4, card.cardNumber.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 5, card.condition.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 6, card.reference.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 7, card.purchasePrice.cents);
+    sqlite3_bind_int64(stmt, 8, (pricePerCard * quantity).cents);
+    sqlite3_bind_int64(stmt, 9, ((pricePerCard - card.purchasePrice) * quantity).cents);
+    sqlite3_bind_int(stmt, 10, quantity);
+    if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+    if (saleId) *saleId = sqlite3_last_insert_rowid(db.handle());
+
+    int remaining_qty = card.quantity - quantity;
+    if (remaining_qty <= 0) {
+        stmt = db.prepare("DELETE FROM inventory WHERE id = ?;");
+        sqlite3_bind_int(stmt, 1, card.id);
+    }
+    else {
+        stmt = db.prepare("UPDATE inventory SET quantity = ? WHERE id = ?;");
+        sqlite3_bind_int(stmt, 1, remaining_qty);
+        sqlite3_bind_int(stmt, 2, card.id);
+    }
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+// Sells every line of the cart or none of them. All lines are checked
+// against the current quantities first (a card may appear on several lines),
+// then the sales rows and inventory changes are written inside one
+// savepoint, so a crash or a bad line never leaves a sale without its
+// inventory update. Works standalone or inside an open transaction.
+bool checkout(Database& db, const vector<CheckoutLine>& cart, string& error) {
+    if (cart.empty()) { error = "the cart is empty"; return false; }
+    if (!execCached(db, "SAVEPOINT checkout;")) { error = sqlite3_errmsg(db.handle()); return false; }
+    auto fail = [&](const string& message) {
+        error = message;
+        execCached(db, "ROLLBACK TO checkout;");
+        changeCapture.invalidate();
+        execCached(db, "RELEASE checkout;");
+        return false;
+    };
+
+    map<int, CardCollection> cards;
+    map<int, int> requested;
+    for (size_t i = 0; i < cart.size(); ++i) {
+        const CheckoutLine& line = cart[i];
+        string where = "line " + to_string(i + 1) + ": ";
+        if (line.quantity <= 0 || line.pricePerCard < Money()) return fail(where + "quantity must be positive and price not negative");
+        if (!cards.count(line.cardId)) {
+            CardCollection card;
+            if (!loadCardById(db, line.cardId, card)) return fail(where + "no card with id " + to_string(line.cardId));
+            cards.emplace(line.cardId, card);
+        }
+        int total = requested[line.cardId] += line.quantity;
+        if (total > cards[line.cardId].quantity) {
+            return fail(where + "card " + to_string(line.cardId) + " has " + to_string(cards[line.cardId].quantity)
+                + " copies, the cart sells " + to_string(total));
+        }
+    }
+
+    for (const CheckoutLine& line : cart) {
+        CardCollection& card = cards[line.cardId];
+        if (!recordSale(db, card, line.quantity, line.pricePerCard)) return fail(sqlite3_errmsg(db.handle()));
+        card.quantity -= line.quantity;
+    }
+    if (!execCached(db, "RELEASE checkout;")) return fail(sqlite3_errmsg(db.handle()));
+    return true;
+}
+
+// Reads a cart from the keyboard (cardId,quantity,pricePerCard per line, a
+// blank line to finish) or from a CSV file given as @path, then checks it out.
+void checkoutCart(Database& db) {
+    cout << "\n--- Checkout ---\n";
+    cout << "Enter one sale per line as cardId,quantity,pricePerCard.\n";
+    cout << "Finish with a blank line, or enter @file.csv to load the cart from a file.\n";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    vector<CheckoutLine> cart;
+    vector<string_view> fields;
+    auto addLine = [&](const vector<string_view>& f, size_t lineNumber) {
+        CheckoutLine line;
+        if (f.size() != 3 || !parseCsvInt(f[0], line.cardId) || !parseCsvInt(f[1], line.quantity) || !parseCsvMoney(f[2], line.pricePerCard)) {
+            cout << "Skipping line " << lineNumber << ": expected cardId,quantity,pricePerCard\n";
+            return;
+        }
+        cart.push_back(line);
+    };
+
+    string input;
+    while (getline(cin, input)) {
+        input = trim(input);
+        if (input.empty()) break;
+        if (input[0] == '@') {
+            CsvReader reader(trim(input.substr(1)));
+            if (!reader.is_open()) { cout << "Could not open " << input.substr(1) << "\n"; continue; }
+            while (reader.next(fields)) {
+                if (fields.size() == 1 && fields[0].empty()) continue;
+                addLine(fields, reader.lineNumber());
+            }
+            cout << "Cart now has " << cart.size() << " lines.\n";
+            continue;
+        }
+        splitCsvRecord(&input[0], &input[0] + input.size(), fields);
+        addLine(fields, cart.size() + 1);
+    }
+    if (cart.empty()) { cout << "Nothing to check out.\n"; return; }
+
+    string error;
+    if (!checkout(db, cart, error)) {
+        cout << "Checkout failed, nothing was sold: " << error << "\n";
+        return;
+    }
+    int copies = 0;
+    Money total;
+    for (const CheckoutLine& line : cart) {
+        copies += line.quantity;
+        total += line.pricePerCard * line.quantity;
+    }
+    cout << "Sold " << copies << " cards in " << cart.size() << " lines for $" << total << ".\n";
+}
+
+void editCard(InventoryModel& inventory, Database& db) {
+    ProfileScope scope(profiler, "editCard");
     if (inventory.empty()) {
         cout << "\nThere is nothing Currently in your inventory\n";
         return;
     }
     cout << "\n--- Select a card to edit ---\n";
-    for (size_t i = 0; i < inventory.size(); ++i) {
-        cout << i + 1 << ". " << inventory[i].name << " #" << inventory[i].cardNumber << "\n";
-    }
-    cout << "------------------\n";
-    int cardChoice = 0;
-    while (true) {
-        cout << "Enter the number of the card to edit (or 0 to cancel):";
-        cin >> cardChoice;
-        if (!cin.fail() && cardChoice >= 0 && (size_t)cardChoice <= inventory.size()) break;
-        cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        cout << "Invalid Input.\n";
-    }
-    if (cardChoice == 0) { return; }
-    int index = cardChoice - 1;
-    CardCollection& cardToEdit = inventory[index];
+    int index = pickRow(inventory, "Card name: ", [&](PageWriter& out, const CardRow& row) {
+        out << row.name << "  " << inventory.dictionary.get(row.setName) << " #" << row.cardNumber
+            << "  " << inventory.dictionary.get(row.condition) << "  qty " << row.quantity;
+    });
+    if (index < 0) { return; }
+    CardCollection cardToEdit = inventory.card(index);
     int card_db_id = cardToEdit.id;
 
     cout << "\nEditing: " << cardToEdit.name << "\n";
@@ -385,80 +1628,46 @@ void editCard(vector<CardCollection>& inventory, sqlite3* db) {
     cin >> editChoice;
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-    sqlite3_stmt* stmt = nullptr;
+    Statement stmt;
     switch (editChoice) {
-    case 1: { string val; cout << "New Sport or TCG: "; getline(cin, val); const char* sql = "UPDATE inventory SET type = ? WHERE id = ?"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break;}
-    case 2: { string val; cout << "New Name: "; getline(cin, val); const char* sql = "UPDATE inventory SET name = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 3: { string val; cout << "New Set: "; getline(cin, val); const char* sql = "UPDATE inventory SET setName = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 4: { string val; cout << "New Card Number: "; getline(cin, val); const char* sql = "UPDATE inventory SET cardNumber = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 5: { string val; cout << "New Condition: "; getline(cin, val); const char* sql = "UPDATE inventory SET condition = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 6: { string val; cout << "New Reference: "; getline(cin, val); const char* sql = "UPDATE inventory SET reference = ? where id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 7: { double val; cout << "New Purchase Price: $"; cin >> val; const char* sql = "UPDATE inventory SET purchasePrice = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_double(stmt, 1, val); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 8: { double val; cout << "New Ebay Comp Value: $"; cin >> val; const char* sql = "UPDATE inventory SET ebayCompValue = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_double(stmt, 1, val); sqlite3_bind_int(stmt, 2, card_db_id); break; }
-    case 9: { int val; cout << "New Quantity: "; cin >> val; const char* sql = "UPDATE inventory SET quantity = ? WHERE id = ?;"; sqlite3_prepare_v2(db, sql, -1, &stmt, NULL); sqlite3_bind_int(stmt, 1, val); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 1: { string val; cout << "New Sport or TCG: "; getline(cin, val); const char* sql = "UPDATE inventory SET type = ? WHERE id = ?"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break;}
+    case 2: { string val; cout << "New Name: "; getline(cin, val); const char* sql = "UPDATE inventory SET name = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 3: { string val; cout << "New Set: "; getline(cin, val); const char* sql = "UPDATE inventory SET setName = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 4: { string val; cout << "New Card Number: "; getline(cin, val); const char* sql = "UPDATE inventory SET cardNumber = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 5: { string val; cout << "New Condition: "; getline(cin, val); const char* sql = "UPDATE inventory SET condition = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 6: { string val; cout << "New Reference: "; getline(cin, val); const char* sql = "UPDATE inventory SET reference = ? where id = ?;"; stmt = db.prepare(sql); sqlite3_bind_text(stmt, 1, val.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 7: { Money val; cout << "New Purchase Price: $"; cin >> val; const char* sql = "UPDATE inventory SET purchasePrice = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_int64(stmt, 1, val.cents); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 8: { Money val; cout << "New Ebay Comp Value: $"; cin >> val; const char* sql = "UPDATE inventory SET ebayCompValue = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_int64(stmt, 1, val.cents); sqlite3_bind_int(stmt, 2, card_db_id); break; }
+    case 9: { int val; cout << "New Quantity: "; cin >> val; const char* sql = "UPDATE inventory SET quantity = ? WHERE id = ?;"; stmt = db.prepare(sql); sqlite3_bind_int(stmt, 1, val); sqlite3_bind_int(stmt, 2, card_db_id); break; }
     case 0: {
         char confirm = 'n';
         cout << "Are you sure you want to delete '" << cardToEdit.name << "'? (y/n): ";
         cin >> confirm;
         if (confirm == 'y' || confirm == 'Y') {
             const char* sql = "DELETE FROM inventory WHERE id = ?;";
-            sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+            stmt = db.prepare(sql);
             sqlite3_bind_int(stmt, 1, card_db_id);
-            if (sqlite3_step(stmt) != SQLITE_DONE) cerr << "Error deleting card: " << sqlite3_errmsg(db) << endl;
+            if (sqlite3_step(stmt) != SQLITE_DONE) cerr << "Error deleting card: " << sqlite3_errmsg(db.handle()) << endl;
             else cout << "Card deleted.\n";
         }
         else { cout << "Deletion cancelled.\n"; }
-        sqlite3_finalize(stmt);
         return;
     }
     case 10: {
         int quantityToSell = 0;
         if (cardToEdit.quantity > 1) { while (true) { cout << "You have " << cardToEdit.quantity << " copies. How many are you selling? "; cin >> quantityToSell; if (!cin.fail() && quantityToSell > 0 && quantityToSell <= cardToEdit.quantity) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; } }
         else { quantityToSell = 1; }
-        double salePricePerCard = 0.0;
-        while (true) { cout << "Enter the final sale price PER CARD: $"; cin >> salePricePerCard; if (!cin.fail() && salePricePerCard >= 0) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; }
-
-        soldCard newSoldCard;
-        newSoldCard.type = cardToEdit.type;
-        newSoldCard.name = cardToEdit.name; newSoldCard.setName = cardToEdit.setName; newSoldCard.cardNumber = cardToEdit.cardNumber;
-        newSoldCard.condition = cardToEdit.condition; newSoldCard.purchasePrice = cardToEdit.purchasePrice;
-        newSoldCard.reference = cardToEdit.reference;
-        newSoldCard.quantitySold = quantityToSell; newSoldCard.finalSoldPrice = salePricePerCard * quantityToSell;
-        newSoldCard.profitMade = (salePricePerCard - newSoldCard.purchasePrice) * quantityToSell;
-
-        const char* sql_insert = "INSERT INTO sales ( type, name, setName, cardNumber, condition, purchasePrice, finalSoldPrice, profitMade, quantitySold) VALUES (?,?,?,?,?,?,?,?,?);";
-        sqlite3_prepare_v2(db, sql_insert, -1, &stmt, NULL);
-        sqlite3_bind_text(stmt, 1, newSoldCard.type.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, newSoldCard.name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 3, newSoldCard.setName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, newSoldCard.cardNumber.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 5, newSoldCard.condition.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 6, newSoldCard.reference.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_double(stmt, 7, newSoldCard.purchasePrice);
-        sqlite3_bind_double(stmt, 8, newSoldCard.finalSoldPrice);
-        sqlite3_bind_double(stmt, 9, newSoldCard.profitMade);
-        sqlite3_bind_int(stmt, 10, newSoldCard.quantitySold);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        Money salePricePerCard;
+        while (true) { cout << "Enter the final sale price PER CARD: $"; cin >> salePricePerCard; if (!cin.fail() && salePricePerCard >= Money()) break; cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid input.\n"; }
 
-        int remaining_qty = cardToEdit.quantity - quantityToSell;
-        if (remaining_qty <= 0) {
-            const char* sql_delete = "DELETE FROM inventory WHERE id = ?;";
-            sqlite3_prepare_v2(db, sql_delete, -1, &stmt, NULL);
-            sqlite3_bind_int(stmt, 1, card_db_id);
-            sqlite3_step(stmt);
-            sqlite3_finalize(stmt);
-            cout << "All copies sold. Card removed from inventory.\n";
-        }
-        else {
-            const char* sql_update = "UPDATE inventory SET quantity = ? WHERE id = ?;";
-            sqlite3_prepare_v2(db, sql_update, -1, &stmt, NULL);
-            sqlite3_bind_int(stmt, 1, remaining_qty);
-            sqlite3_bind_int(stmt, 2, card_db_id);
-            sqlite3_step(stmt);
-            sqlite3_finalize(stmt);
-            cout << "Remaining quantity: " << remaining_qty << "\n";
+        string error;
+        if (!checkout(db, { { cardToEdit.id, quantityToSell, salePricePerCard } }, error)) {
+            cerr << "Error recording sale: " << error << endl;
+            return;
         }
+        int remaining_qty = cardToEdit.quantity - quantityToSell;
+        if (remaining_qty <= 0) cout << "All copies sold. Card removed from inventory.\n";
+        else cout << "Remaining quantity: " << remaining_qty << "\n";
         cout << "Sale recorded successfully.\n";
         return;
     }
@@ -471,98 +1680,106 @@ void editCard(vector<CardCollection>& inventory, sqlite3* db) {
             cout << "Card updated successfully.\n";
         }
         else {
-            cerr << "Error updating card: " << sqlite3_errmsg(db) << endl;
+            cerr << "Error updating card: " << sqlite3_errmsg(db.handle()) << endl;
         }
-        sqlite3_finalize(stmt);
     }
 }
 
-void printInventory(sqlite3* db) {
+void printInventory(Database& db) {
+    ProfileScope scope(profiler, "printInventory");
     cout << "\n- - - Your Card Inventory - - - \n";
-    cout << "1. Search by Name\n2. Alphabetically (A-Z)\n3. By Highest Value\n4. By Highest Potential Profit\n5. Search by Set\n6. By order of Entry (Newest First)\n6.Sport or TCG\n7. Reference #\n0. Cancel\n";
+    cout << "1. Search by Name\n2. Alphabetically (A-Z)\n3. By Highest Value\n4. By Highest Potential Profit\n5. Search by Set\n6. By order of Entry (Newest First)\n7. Sport or TCG\n8. Search by Reference #\n9. By Highest Market Value (value x quantity)\n0. Cancel\n";
     int sortChoice;
     cin >> sortChoice;
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-    string sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory ";
     string search_term;
     switch (sortChoice) {
-    case 1:
-        cout << "Enter Card to search: "; getline(cin, search_term);
-        sql += "WHERE name LIKE ? ORDER BY name;";
+    case 1: cout << "Enter Card to search: "; getline(cin, search_term); break;
+    case 5: cout << "Enter desired Set Name: "; getline(cin, search_term); break;
+    case 8: cout << "Enter Reference Number: "; getline(cin, search_term); break;
+    case 0: cout << "Cancelled.\n"; return;
+    default:
+        if (sortChoice < 0 || sortChoice > 9) { cout << "Invalid choice.\n"; return; }
         break;
-    case 2: sql += "ORDER BY name;"; break;
-    case 3: sql += "ORDER BY ebayCompValue DESC;"; break;
-    case 4: sql += "ORDER BY (ebayCompValue - purchasePrice) * quantity DESC;"; break;
-    case 5:
-        cout << "Enter desired Set Name: "; getline(cin, search_term);
-        sql += "WHERE setName LIKE ? ORDER BY name;";
-        break;
-    case 6: sql += "ORDER BY id DESC;"; break;
-    case 7: sql += "ORDER BY type; "; break;
-    case 8:
-        cout << "Enter Reference Number: "; getline(cin, search_term);
-        sql += "WHERE reference LIKE ? ORDER BY reference;";
-            break;
-    case 0: cout << "Cancelled.\n"; return;
-    default: cout << "Invalid choice.\n"; return;
+    }
+    ListingQuery query = inventoryListingQuery(db, sortChoice, search_term);
+
+    // The value and profit rankings are usually only read from the top, so
+    // offer a limit; with the index on the sort column SQLite then stops
+    // after N rows instead of sorting the whole table.
+    int topN = 0;
+    if (sortChoice == 3 || sortChoice == 4 || sortChoice == 9) {
+        cout << "Show top how many? (0 for all): ";
+        cin >> topN;
+        if (cin.fail() || topN < 0) { cin.clear(); topN = 0; }
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
     }
 
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL);
+    cout << "\n- - - Displaying Inventory - - -\n";
+    runPagedListing(db, query, displayCardDetails, "No cards found matching your criteria.\n", topN);
+}
 
-    if (sortChoice == 1 || sortChoice == 5) {
-        string pattern = "%" + search_term + "%";
-        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+// Builds the listing for one of printInventory()'s sort modes (1-9);
+// searchTerm is used by the search modes 1, 5 and 8.
+ListingQuery inventoryListingQuery(Database& db, int sortChoice, const string& searchTerm) {
+    ListingQuery query;
+    query.columns = "inventory.id, inventory.type, inventory.name, inventory.setName, inventory.cardNumber, inventory.condition, inventory.reference, inventory.purchasePrice, inventory.ebayCompValue, inventory.quantity";
+    query.from = "inventory";
+    query.idColumn = "inventory.id";
+    string searchColumn;
+    switch (sortChoice) {
+    case 1: query.sortKey = "inventory.name"; searchColumn = "name"; break;
+    case 2: query.sortKey = "inventory.name"; break;
+    case 3: query.sortKey = "inventory.ebayCompValue"; query.descending = true; break;
+    case 4: query.sortKey = "inventory.potentialProfit"; query.descending = true; break;
+    case 5: query.sortKey = "inventory.name"; searchColumn = "setName"; break;
+    case 6: query.sortKey = "inventory.id"; query.descending = true; break;
+    case 7: query.sortKey = "inventory.type"; break;
+    case 8: query.sortKey = "inventory.reference"; searchColumn = "reference"; break;
+    case 9: query.sortKey = "inventory.marketValue"; query.descending = true; break;
     }
 
-    cout << "\n- - - Displaying Inventory - - -\n";
-    int count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        CardCollection card;
-        card.id = sqlite3_column_int(stmt, 0);
-        card.type = (const char*)sqlite3_column_text(stmt, 1);
-        card.name = (const char*)sqlite3_column_text(stmt, 2);
-        card.setName = (const char*)sqlite3_column_text(stmt, 3);
-        card.cardNumber = (const char*)sqlite3_column_text(stmt, 4);
-        card.condition = (const char*)sqlite3_column_text(stmt, 5);
-        card.reference = (const char*)sqlite3_column_text(stmt, 6);
-        card.purchasePrice = sqlite3_column_double(stmt, 7);
-        card.ebayCompValue = sqlite3_column_double(stmt, 8);
-        card.quantity = sqlite3_column_int(stmt, 9);
-        displayCardDetails(card);
-        count++;
-    }
-    if (count == 0) {
-        cout << "No cards found matching your criteria.\n";
-    }
-    sqlite3_finalize(stmt);
-}
-
-void analyzeInventory(sqlite3* db) {
-    cout << "\n--- Inventory Analysis ---\n";
-    const char* sql = "SELECT SUM(purchasePrice * quantity), SUM(ebayCompValue * quantity), SUM((ebayCompValue - purchasePrice) * quantity) FROM inventory;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
-            double totalPurchasePrice = sqlite3_column_double(stmt, 0);
-            double totalMarketValue = sqlite3_column_double(stmt, 1);
-            double totalPotentialProfit = sqlite3_column_double(stmt, 2);
-
-            cout << "--------------------------------\n";
-            cout << "Total Purchase Price: $" << fixed << setprecision(2) << totalPurchasePrice << endl;
-            cout << "Total Market Value: $" << fixed << setprecision(2) << totalMarketValue << endl;
-            cout << "Total Potential Profit: $" << fixed << setprecision(2) << totalPotentialProfit << endl;
-            cout << "--------------------------------\n";
+    // Searches go through the FTS index (prefix match, best match first);
+    // LIKE on the column is only used if the index is unavailable.
+    if (!searchColumn.empty()) {
+        string match = buildFtsQuery(searchColumn, searchTerm);
+        if (!match.empty() && tableExists(db, "inventory_fts")) {
+            query.from = "inventory_fts JOIN inventory ON inventory.id = inventory_fts.rowid";
+            query.filter = "inventory_fts MATCH ?";
+            query.filterValue = match;
+            query.sortKey = "inventory_fts.rank";
         }
         else {
-            cout << "No inventory to analyze.\n";
+            query.filter = "inventory." + searchColumn + " LIKE ?";
+            query.filterValue = "%" + searchTerm + "%";
         }
     }
-    sqlite3_finalize(stmt);
+    return query;
+}
+
+void analyzeInventory(Database& db, ColumnSnapshot& snapshot) {
+    cout << "\n--- Inventory Analysis ---\n";
+    refreshSnapshot(db, snapshot);
+    const InventoryColumns& inv = snapshot.inventory;
+    if (!inv.quantity.empty()) {
+        Money totalPurchasePrice = Money::fromCents(sumProduct(inv.purchasePrice, inv.quantity));
+        Money totalMarketValue = Money::fromCents(sumProduct(inv.ebayCompValue, inv.quantity));
+        Money totalPotentialProfit = totalMarketValue - totalPurchasePrice;
+
+        cout << "--------------------------------\n";
+        cout << "Total Purchase Price: $" << totalPurchasePrice << endl;
+        cout << "Total Market Value: $" << totalMarketValue << endl;
+        cout << "Total Potential Profit: $" << totalPotentialProfit << endl;
+        cout << "--------------------------------\n";
+    }
+    else {
+        cout << "No inventory to analyze.\n";
+    }
 }
 
-void printSalesLog(sqlite3* db) {
+void printSalesLog(Database& db) {
+    ProfileScope scope(profiler, "printSalesLog");
     cout << "\n--- Detailed Sales Log ---\n";
     cout << "How would you like to sort?\n";
     cout << "1. By Highest Profit\n";
@@ -588,128 +1805,366 @@ void printSalesLog(sqlite3* db) {
         return;
     }
 
-    string sql = "SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold FROM sales ";
     string search_term;
     switch (sortChoice) {
-    case 1:
-        sql += "ORDER BY profitMade DESC;";
-        break;
-    case 2:
-        sql += "ORDER BY name ASC;";
-        break;
-    case 3:
-        sql += "ORDER BY id DESC;";
-        break;
-    case 4: {
+    case 1: case 2: case 3: break;
+    case 4:
         cout << "Enter card name to search for: ";
         // Clear the newline character left by 'cin >> sortChoice;'
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         getline(cin, search_term);
-        sql += "WHERE name LIKE ? ORDER BY name;";
         break;
-    }
-    case 5: {
-        cout << "Enter Reference Number: "; getline(cin, search_term);
-        sql += "WHERE reference LIKE ? ORDER BY reference;";
+    case 5:
+        cout << "Enter Reference Number: ";
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        getline(cin, search_term);
         break;
-    }
     default:
         cout << "Invalid choice.\n";
         return;
     }
+    ListingQuery query = salesListingQuery(db, sortChoice, search_term);
 
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL);
+    cout << "\n--- Displaying Sales ---\n";
+    runPagedListing(db, query, displaySoldCardDetails, "No sales found matching your criteria.\n", 0);
+}
 
-    // Bind the search term only if the user chose the search option
-    if (sortChoice == 4) {
-        string pattern = "%" + search_term + "%";
-        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+// Builds the listing for one of printSalesLog()'s sort modes (1-5);
+// searchTerm is used by the search modes 4 and 5.
+ListingQuery salesListingQuery(Database& db, int sortChoice, const string& searchTerm) {
+    ListingQuery query;
+    query.columns = "sales.id, sales.type, sales.name, sales.setName, sales.cardNumber, sales.condition, sales.reference, sales.purchasePrice, sales.finalSoldPrice, sales.profitMade, sales.quantitySold, sales.soldAt";
+    query.from = "sales";
+    query.idColumn = "sales.id";
+    string searchColumn;
+    switch (sortChoice) {
+    case 1: query.sortKey = "sales.profitMade"; query.descending = true; break;
+    case 2: query.sortKey = "sales.name"; break;
+    case 3: query.sortKey = "sales.id"; query.descending = true; break;
+    case 4: query.sortKey = "sales.name"; searchColumn = "name"; break;
+    case 5: query.sortKey = "sales.reference"; searchColumn = "reference"; break;
     }
 
-    cout << "\n--- Displaying Sales ---\n";
-    int count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        soldCard sale;
-        sale.id = sqlite3_column_int(stmt, 0);
-        sale.type = (const char*)sqlite3_column_text(stmt, 1);
-        sale.name = (const char*)sqlite3_column_text(stmt, 2);
-        sale.setName = (const char*)sqlite3_column_text(stmt, 3);
-        sale.cardNumber = (const char*)sqlite3_column_text(stmt, 4);
-        sale.condition = (const char*)sqlite3_column_text(stmt, 5);
-        sale.reference = (const char*)sqlite3_column_text(stmt, 5);
-        sale.purchasePrice = sqlite3_column_double(stmt, 7);
-        sale.finalSoldPrice = sqlite3_column_double(stmt, 8);
-        sale.profitMade = sqlite3_column_double(stmt, 9);
-        sale.quantitySold = sqlite3_column_int(stmt, 10);
-
-        displaySoldCardDetails(sale); // Call the display function
-        count++;
-    }
-
-    if (count == 0) {
-        cout << "No sales found matching your criteria.\n";
-    }
-    sqlite3_finalize(stmt);
-}
-void analyzeSales(sqlite3* db) {
-    const char* sql = "SELECT SUM(finalSoldPrice), SUM(profitMade) FROM sales;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
-            double totalSalesValue = sqlite3_column_double(stmt, 0);
-            double totalProfitMade = sqlite3_column_double(stmt, 1);
-
-            cout << "\n- - - Lifetime Sales Summary - - -\n";
-            cout << "Total Sales Value: $" << fixed << setprecision(2) << totalSalesValue << endl;
-            cout << "Total Profit Made: $" << fixed << setprecision(2) << totalProfitMade << endl;
-            cout << "--------------------------------\n";
+    // Same FTS-first search as inventoryListingQuery(), with LIKE as the fallback.
+    if (!searchColumn.empty()) {
+        string match = buildFtsQuery(searchColumn, searchTerm);
+        if (!match.empty() && tableExists(db, "sales_fts")) {
+            query.from = "sales_fts JOIN sales ON sales.id = sales_fts.rowid";
+            query.filter = "sales_fts MATCH ?";
+            query.filterValue = match;
+            query.sortKey = "sales_fts.rank";
         }
         else {
-            cout << "No sales to analyze.\n";
+            query.filter = "sales." + searchColumn + " LIKE ?";
+            query.filterValue = "%" + searchTerm + "%";
         }
     }
-    sqlite3_finalize(stmt); 
+    return query;
 }
-void deleteSale(vector<soldCard>& sales, sqlite3* db) {
-    cout << "\n --- Select a Sale to Delete ---\n";
-    if (sales.empty()) {
-        cout << "There are no sales to delete. \n";
-        return;
+
+// Builds one page query for a listing. cursorOp is "" for the first page,
+// or the comparison that continues past / backs up from the cursor row.
+// reverse flips the sort so the previous page can be found from its end.
+string buildPageSql(const ListingQuery& query, const string& cursorOp, bool reverse) {
+    bool descending = query.descending != reverse;
+    string sql = "SELECT " + query.columns + ", " + query.sortKey + " FROM " + query.from;
+    string where = query.filter;
+    if (!cursorOp.empty()) {
+        if (!where.empty()) where += " AND ";
+        where += "(" + query.sortKey + ", " + query.idColumn + ") " + cursorOp + " (?, ?)";
     }
-    cout << "0. Cancel\n";
-    for (size_t i = 0; i < sales.size(); ++i) {
-        cout << i + 1 << ". " << sales[i].name
-            << " (Sold for $" << fixed << setprecision(2) << sales[i].finalSoldPrice << ")\n";
+    if (!where.empty()) sql += " WHERE " + where;
+    const char* dir = descending ? " DESC" : "";
+    sql += " ORDER BY " + query.sortKey + dir + ", " + query.idColumn + dir + " LIMIT ?;";
+    return sql;
+}
+
+// Binds the filter, optional cursor and page limit of a page query.
+void bindPageQuery(sqlite3_stmt* stmt, const ListingQuery& query, sqlite3_value* cursorKey, sqlite3_int64 cursorId, int limit) {
+    int index = 1;
+    if (!query.filter.empty()) sqlite3_bind_text(stmt, index++, query.filterValue.c_str(), -1, SQLITE_TRANSIENT);
+    if (cursorKey) {
+        sqlite3_bind_value(stmt, index++, cursorKey);
+        sqlite3_bind_int64(stmt, index++, cursorId);
     }
-    cout << "----------------------------------\n";
-    cout << "Select the Number of cards you would like to delete\n";
-    int choice = 0;
-    while (true) {
-        cout << "Enter the number of the sale to delete (or 0 to cancel): ";
-        cin >> choice;
+    sqlite3_bind_int(stmt, index, limit);
+}
 
-        if (cin.fail()) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            cout << "Invalid input. Please enter a number.\n";
-            continue; 
+// Runs work(), which steps statements on db, on a worker thread so this
+// thread stays responsive: every 100 ms it writes whatever rows work() has
+// rendered into out so far (under outMutex), shows a progress line once the
+// query has taken longer than a moment, and turns Ctrl+C into a cancel via
+// the progress handler, which makes the pending sqlite3_step() return
+// SQLITE_INTERRUPT. Nothing else may use db until this returns. Returns
+// false if the query was cancelled.
+template <typename Work>
+bool runCancellable(Database& db, QueryProgress& progress, PageWriter& out, mutex& outMutex, Work work) {
+    QueryProgress::Scope handler(db.handle(), progress);
+    InterruptCapture interrupt;
+    auto started = chrono::steady_clock::now();
+    future<void> result = async(launch::async, work);
+    bool progressShown = false;
+    auto clearProgress = [&] {
+        if (progressShown) cerr << "\r" << string(72, ' ') << "\r" << flush;
+        progressShown = false;
+    };
+    while (result.wait_for(chrono::milliseconds(100)) != future_status::ready) {
+        if (interruptRequested) progress.cancel = true;
+        {
+            lock_guard<mutex> lock(outMutex);
+            if (out.size() > 0) {
+                clearProgress();
+                out.flush();
+            }
+        }
+        if (chrono::steady_clock::now() - started >= chrono::milliseconds(300)) {
+            cerr << "\r" << (progress.cancel ? "Cancelling... " : "Working... ") << progress.rows << " rows, "
+                << progress.instructions / 1000 << "k steps (Ctrl+C to cancel)" << flush;
+            progressShown = true;
         }
+    }
+    result.get();
+    clearProgress();
+    return !progress.cancel;
+}
+
+// Shows a listing one page at a time. Each page is a keyset query that
+// resumes from the first or last row on screen (never OFFSET), is formatted
+// into one buffer and written at once, so the first page appears right away
+// however large the table is. Each query runs through runCancellable(), so
+// slow searches stream their rows and can be abandoned with Ctrl+C.
+// topN > 0 caps the total number of rows.
+void runPagedListing(Database& db, const ListingQuery& query, void (*displayRow)(PageWriter&, sqlite3_stmt*), const char* emptyMessage, int topN) {
+    static int pageSize = 20;
+    const string firstPageSql = buildPageSql(query, "", false);
+    const string nextPageSql = buildPageSql(query, query.descending ? "<" : ">", false);
+    const string pageFromSql = buildPageSql(query, query.descending ? "<=" : ">=", false);
+    const string prevPageSql = buildPageSql(query, query.descending ? ">" : "<", true);
+
+    // Sort key and id of the first and last rows currently on screen.
+    sqlite3_value* firstKey = nullptr;
+    sqlite3_value* lastKey = nullptr;
+    sqlite3_int64 firstId = 0, lastId = 0;
+    int rowsBefore = 0;
+    PageWriter out;
+
+    mutex outMutex;
+    bool cancelled = false;
+
+    // Runs stmt and renders its rows as the new current page; returns the row
+    // count. Rows are shown as they arrive, and Ctrl+C abandons the query.
+    auto showPage = [&](Statement& stmt) {
+        ProfileScope scope(profiler, "runPagedListing: query + format");
+        int rows = 0;
+        int keyColumn = sqlite3_column_count(stmt) - 1;
+        QueryProgress progress;
+        cancelled = !runCancellable(db, progress, out, outMutex, [&] {
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                {
+                    lock_guard<mutex> lock(outMutex);
+                    displayRow(out, stmt);
+                }
+                if (rows == 0) {
+                    sqlite3_value_free(firstKey);
+                    firstKey = sqlite3_value_dup(sqlite3_column_value(stmt, keyColumn));
+                    firstId = sqlite3_column_int64(stmt, 0);
+                }
+                sqlite3_value_free(lastKey);
+                lastKey = sqlite3_value_dup(sqlite3_column_value(stmt, keyColumn));
+                lastId = sqlite3_column_int64(stmt, 0);
+                progress.rows = ++rows;
+            }
+        });
+        return rows;
+    };
+    auto limitFor = [&](int before) {
+        return topN > 0 ? min(pageSize, topN - before) : pageSize;
+    };
+
+    Statement stmt = db.prepare(firstPageSql);
+    bindPageQuery(stmt, query, nullptr, 0, limitFor(0));
+    int rowsOnPage = showPage(stmt);
+    if (rowsOnPage == 0 && !cancelled) {
+        cout << emptyMessage;
+        return;
+    }
 
-        if (choice >= 0 && (size_t)choice <= sales.size()) {
-            break; 
+    while (true) {
+        if (cancelled) {
+            out << "Query cancelled after " << rowsOnPage << " rows.\n";
+            out.flush();
+            sqlite3_value_free(firstKey);
+            sqlite3_value_free(lastKey);
+            return;
+        }
+        bool atEnd = rowsOnPage < limitFor(rowsBefore) || (topN > 0 && rowsBefore + rowsOnPage >= topN);
+        out << "Showing rows " << rowsBefore + 1 << "-" << rowsBefore + rowsOnPage << (atEnd ? " (end)" : "") << "\n";
+        out << "[n]ext page, [p]revious page, [s]et page size (" << pageSize << "), [q]uit: ";
+        {
+            ProfileScope scope(profiler, "runPagedListing: terminal write");
+            out.flush();
+        }
+
+        string command;
+        if (!(cin >> command) || command == "q" || command == "Q") break;
+
+        if (command == "n" || command == "N") {
+            if (atEnd) { cout << "Already at the last page.\n"; continue; }
+            stmt = db.prepare(nextPageSql);
+            bindPageQuery(stmt, query, lastKey, lastId, limitFor(rowsBefore + rowsOnPage));
+            rowsBefore += rowsOnPage;
+            rowsOnPage = showPage(stmt);
+        }
+        else if (command == "p" || command == "P") {
+            if (rowsBefore == 0) { cout << "Already at the first page.\n"; continue; }
+            // Walk backwards from the current first row to find where the
+            // previous page starts, then show it forwards from there.
+            Statement back = db.prepare(prevPageSql);
+            bindPageQuery(back, query, firstKey, firstId, pageSize);
+            sqlite3_value* startKey = nullptr;
+            sqlite3_int64 startId = 0;
+            int found = 0;
+            int keyColumn = sqlite3_column_count(back) - 1;
+            QueryProgress progress;
+            bool finished = runCancellable(db, progress, out, outMutex, [&] {
+                while (sqlite3_step(back) == SQLITE_ROW) {
+                    sqlite3_value_free(startKey);
+                    startKey = sqlite3_value_dup(sqlite3_column_value(back, keyColumn));
+                    startId = sqlite3_column_int64(back, 0);
+                    progress.rows = ++found;
+                }
+            });
+            if (!finished) {
+                sqlite3_value_free(startKey);
+                cout << "Query cancelled.\n";
+                continue;
+            }
+            rowsBefore = max(0, rowsBefore - found);
+            stmt = db.prepare(pageFromSql);
+            bindPageQuery(stmt, query, startKey, startId, pageSize);
+            rowsOnPage = showPage(stmt);
+            sqlite3_value_free(startKey);
+        }
+        else if (command == "s" || command == "S") {
+            int newSize = 0;
+            cout << "Rows per page: ";
+            if (cin >> newSize && newSize > 0) pageSize = newSize;
+            else { cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n'); cout << "Invalid page size.\n"; }
+            continue;
         }
         else {
-            cout << "Invalid number. Please try again.\n";
+            cout << "Unknown command.\n";
+            continue;
         }
     }
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    sqlite3_value_free(firstKey);
+    sqlite3_value_free(lastKey);
+}
 
-    if (choice == 0) {
+void analyzeSales(Database& db, ColumnSnapshot& snapshot) {
+    refreshSnapshot(db, snapshot);
+    const SalesColumns& sold = snapshot.sales;
+    if (!sold.quantitySold.empty()) {
+        Money totalSalesValue = Money::fromCents(sumColumn(sold.finalSoldPrice));
+        Money totalProfitMade = Money::fromCents(sumColumn(sold.profitMade));
+
+        cout << "\n- - - Lifetime Sales Summary - - -\n";
+        cout << "Total Sales Value: $" << totalSalesValue << endl;
+        cout << "Total Profit Made: $" << totalProfitMade << endl;
+        cout << "--------------------------------\n";
+    }
+    else {
+        cout << "No sales to analyze.\n";
+    }
+}
+
+// Profit and loss by period or category, read from the rollup tables that
+// migration 5 maintains, so the cost does not grow with the sales history.
+void salesReports(Database& db) {
+    cout << "\n--- Period Reports ---\n";
+    cout << "1. Daily (last 31 days with sales)\n2. Monthly (last 24 months with sales)\n3. By Type\n4. By Set (top 25 by profit)\n0. Go Back\nEnter your choice: ";
+    int reportChoice;
+    cin >> reportChoice;
+    if (cin.fail()) {
+        cin.clear(); cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid input.\n";
+        return;
+    }
+
+    const char* measures = "SUM(salesCount), SUM(cardsSold), SUM(revenue), SUM(cost), SUM(profit)";
+    string sql;
+    const char* heading;
+    switch (reportChoice) {
+    case 1:
+        heading = "Day";
+        sql = string("SELECT day, ") + measures + " FROM sales_daily WHERE day <> 'undated' GROUP BY day ORDER BY day DESC LIMIT 31;";
+        break;
+    case 2:
+        heading = "Month";
+        sql = string("SELECT month, ") + measures + " FROM sales_monthly WHERE month <> 'undated' GROUP BY month ORDER BY month DESC LIMIT 24;";
+        break;
+    case 3:
+        heading = "Type";
+        sql = string("SELECT type, ") + measures + " FROM sales_by_category GROUP BY type ORDER BY SUM(profit) DESC;";
+        break;
+    case 4:
+        heading = "Set";
+        sql = string("SELECT setName, ") + measures + " FROM sales_by_category GROUP BY setName ORDER BY SUM(profit) DESC LIMIT 25;";
+        break;
+    case 0: return;
+    default: cout << "Invalid choice.\n"; return;
+    }
+
+    Statement stmt = db.prepare(sql);
+    if (!stmt) {
+        cerr << "Error reading sales rollups: " << sqlite3_errmsg(db.handle()) << endl;
+        return;
+    }
+    PageWriter out;
+    char line[160];
+    snprintf(line, sizeof(line), "\n%-24s %8s %8s %13s %13s %13s %8s\n", heading, "Sales", "Cards", "Revenue", "Cost", "Profit", "Margin");
+    out << line;
+    int rows = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Money revenue = columnMoney(stmt, 3);
+        Money profit = columnMoney(stmt, 5);
+        string key(columnView(stmt, 0).substr(0, 24));
+        snprintf(line, sizeof(line), "%-24s %8d %8d %13s %13s %13s %7.1f%%\n", key.c_str(),
+            sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2), revenue.str().c_str(), columnMoney(stmt, 4).str().c_str(), profit.str().c_str(),
+            revenue.cents != 0 ? (double)profit.cents / revenue.cents * 100.0 : 0.0);
+        out << line;
+        rows++;
+    }
+    if (rows == 0) out << "No sales recorded yet.\n";
+
+    // Sales from before timestamps were recorded cannot be placed in a period.
+    if (reportChoice == 1 || reportChoice == 2) {
+        Statement undated = db.prepare("SELECT salesCount, profit FROM sales_monthly WHERE month = 'undated';");
+        if (sqlite3_step(undated) == SQLITE_ROW) {
+            out << "(" << sqlite3_column_int(undated, 0) << " older sales have no date; profit $";
+            out.money(columnMoney(undated, 1)) << ")\n";
+        }
+    }
+    out.flush();
+}
+
+void deleteSale(SalesModel& sales, Database& db) {
+    cout << "\n --- Select a Sale to Delete ---\n";
+    if (sales.empty()) {
+        cout << "There are no sales to delete. \n";
+        return;
+    }
+    int index = pickRow(sales, "Sold card name: ", [&](PageWriter& out, const SaleRow& row) {
+        out << row.name << "  " << sales.dictionary.get(row.setName) << "  qty " << row.quantitySold << "  sold for $";
+        out.money(row.finalSoldPrice);
+    });
+    if (index < 0) {
         cout << "Deletion cancelled.\n";
         return; 
     }
-    int sale_id_to_delete = sales[choice - 1].id;
-    string sale_name_to_delete = sales[choice - 1].name;
+    int sale_id_to_delete = sales.rows[index].id;
+    string sale_name_to_delete(sales.rows[index].name);
 
     char confirm = 'n';
     cout << "Are you sure you want to delete the sale of '" << sale_name_to_delete << "'? (y/n): ";
@@ -718,9 +2173,7 @@ void deleteSale(vector<soldCard>& sales, sqlite3* db) {
 
     if (confirm == 'y' || confirm == 'Y') {
         const char* sql = "DELETE FROM sales WHERE id = ?;";
-        sqlite3_stmt* stmt;
-
-        sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+        Statement stmt = db.prepare(sql);
 
         sqlite3_bind_int(stmt, 1, sale_id_to_delete);
 
@@ -728,87 +2181,1120 @@ void deleteSale(vector<soldCard>& sales, sqlite3* db) {
             cout << "Sale deleted successfully.\n";
         }
         else {
-            cerr << "Error deleting sale: " << sqlite3_errmsg(db) << endl;
+            cerr << "Error deleting sale: " << sqlite3_errmsg(db.handle()) << endl;
         }
-
-        sqlite3_finalize(stmt);
-
     }
     else {
         cout << "Deletion cancelled.\n";
     }
 }
 
-void importFromCSV(sqlite3* db, const string& filename) {
+// Validates one CSV record (type, name, setName, cardNumber, condition,
+// reference, purchasePrice, ebayCompValue, quantity) into an ImportRow.
+bool parseImportRow(const vector<string_view>& fields, size_t line, ImportRow& row, string& reason) {
+    if (fields.size() != 9) {
+        reason = "expected 9 fields, found " + to_string(fields.size());
+        return false;
+    }
+    if (!parseCsvMoney(fields[6], row.purchasePrice)) { reason = "bad purchasePrice '" + string(fields[6]) + "'"; return false; }
+    if (!parseCsvMoney(fields[7], row.ebayCompValue)) { reason = "bad ebayCompValue '" + string(fields[7]) + "'"; return false; }
+    if (!parseCsvInt(fields[8], row.quantity)) { reason = "bad quantity '" + string(fields[8]) + "'"; return false; }
+    row.line = line;
+    row.type = fields[0];
+    row.name = fields[1];
+    row.setName = fields[2];
+    row.cardNumber = fields[3];
+    row.condition = fields[4];
+    row.reference = fields[5];
+    return true;
+}
+
+// Binds and runs the shared import INSERT for one row, leaving the statement reset.
+bool insertImportRow(sqlite3_stmt* stmt, const ImportRow& row) {
+    sqlite3_bind_text(stmt, 1, row.type.data(), (int)row.type.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, row.name.data(), (int)row.name.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, row.setName.data(), (int)row.setName.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, row.cardNumber.data(), (int)row.cardNumber.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, row.condition.data(), (int)row.condition.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, row.reference.data(), (int)row.reference.size(), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 7, row.purchasePrice.cents);
+    sqlite3_bind_int64(stmt, 8, row.ebayCompValue.cents);
+    sqlite3_bind_int(stmt, 9, row.quantity);
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_reset(stmt);
+    return ok;
+}
+
+void reportImport(int successCount, int failCount, const vector<string>& rejects, double seconds) {
+    cout << "Import complete.\nSuccessfully imported " << successCount << " cards.\nFailed to import " << failCount << " rows.\n";
+    cout << "Elapsed: " << fixed << setprecision(2) << seconds << "s ("
+        << setprecision(0) << (seconds > 0 ? successCount / seconds : successCount) << " rows/sec)\n";
+
+    const size_t maxRejectsShown = 25;
+    for (size_t i = 0; i < rejects.size() && i < maxRejectsShown; ++i) {
+        cout << "  Rejected " << rejects[i] << "\n";
+    }
+    if (rejects.size() > maxRejectsShown) {
+        cout << "  ... and " << rejects.size() - maxRejectsShown << " more rejected rows\n";
+    }
+}
+
+const char* importInsertSql = "INSERT INTO inventory (type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
+const int importBatchSize = 10000;
+
+void importFromCSV(Database& db, const string& filename) {
+    ProfileScope scope(profiler, "importFromCSV");
     cout << "\n--- Importing from " << filename << " ---\n";
-    ifstream inputFile(filename);
+    CsvReader reader(filename);
 
-    if (!inputFile.is_open()) {
+    if (!reader.is_open()) {
         cerr << "Error: Could not open file " << filename << endl;
         return;
     }
 
-    string line;
+    // One statement for the whole file, rows committed in batches so the
+    // journal is synced once per batch instead of once per card.
+    Statement stmt = db.prepare(importInsertSql);
+    if (!stmt) {
+        cerr << "Error preparing import: " << sqlite3_errmsg(db.handle()) << endl;
+        return;
+    }
+
+    const StorageProfile* previousProfile = switchStorageProfile(db, db.bulkProfile());
+    auto startTime = chrono::steady_clock::now();
     int successCount = 0;
     int failCount = 0;
+    int pending = 0;
+    vector<string> rejects;
+    vector<string_view> fields;
+    fields.reserve(16);
+    ImportRow row;
+    string reason;
+
+    reader.next(fields); // header row
+    sqlite3_exec(db.handle(), "BEGIN TRANSACTION;", 0, 0, 0);
+    while (reader.next(fields)) {
+        if (fields.size() == 1 && fields[0].empty()) continue; // blank line
+
+        if (!parseImportRow(fields, reader.lineNumber(), row, reason)) {
+            failCount++;
+            rejects.push_back("line " + to_string(reader.lineNumber()) + ": " + reason);
+            continue;
+        }
+        if (insertImportRow(stmt, row)) {
+            successCount++;
+        }
+        else {
+            failCount++;
+            rejects.push_back("line " + to_string(row.line) + ": " + sqlite3_errmsg(db.handle()));
+        }
+
+        if (++pending >= importBatchSize) {
+            sqlite3_exec(db.handle(), "COMMIT; BEGIN TRANSACTION;", 0, 0, 0);
+            pending = 0;
+        }
+    }
+    sqlite3_exec(db.handle(), "COMMIT;", 0, 0, 0);
+    stmt = Statement();
+    switchStorageProfile(db, previousProfile);
 
-    getline(inputFile, line);
-
-    while (getline(inputFile, line)) {
-        stringstream ss(line);
-        string field;
-        vector<string> fields;
-
-        while (getline(ss, field, ',')) {
-            fields.push_back(field);
-        }
-
-        if (fields.size() == 8) {
-            CardCollection newCard;
-            try {
-                newCard.type = trim(fields[0]);
-                newCard.name = trim(fields[1]);
-                newCard.setName = trim(fields[2]);
-                newCard.cardNumber = trim(fields[3]);
-                newCard.condition = trim(fields[4]);
-                newCard.reference = trim(fields[5]);
-                newCard.purchasePrice = stod(fields[6]);
-                newCard.ebayCompValue = stod(fields[7]);
-                newCard.quantity = stoi(fields[8]);
-
-                const char* sql_insert = "INSERT INTO inventory (type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity) VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
-                sqlite3_stmt* stmt;
-                sqlite3_prepare_v2(db, sql_insert, -1, &stmt, NULL);
-
-                sqlite3_bind_text(stmt, 1, newCard.type.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 2, newCard.name.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 3, newCard.setName.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 4, newCard.cardNumber.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 5, newCard.condition.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 6, newCard.reference.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_double(stmt, 7, newCard.purchasePrice);
-                sqlite3_bind_double(stmt, 8, newCard.ebayCompValue);
-                sqlite3_bind_int(stmt, 9, newCard.quantity);
-
-                if (sqlite3_step(stmt) == SQLITE_DONE) {
+    reportImport(successCount, failCount, rejects, chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+}
+
+// Parses every record in a batch's text into rows, on a worker thread.
+void parseImportBatch(ImportBatch& batch) {
+    vector<string_view> fields;
+    fields.reserve(16);
+    string reason;
+    char* p = batch.text.data();
+    char* end = p + batch.text.size();
+    size_t line = batch.startLine;
+    while (p < end) {
+        const char* recordEnd = findCsvRecordEnd(p, end);
+        char* stop = recordEnd ? const_cast<char*>(recordEnd) : end;
+        size_t recordLine = line;
+        line += 1 + count(p, stop, '\n');
+        splitCsvRecord(p, stop, fields);
+        p = stop + 1;
+
+        if (fields.size() == 1 && fields[0].empty()) continue; // blank line
+        ImportRow row;
+        if (parseImportRow(fields, recordLine, row, reason)) {
+            batch.rows.push_back(row);
+        }
+        else {
+            batch.rejects.push_back("line " + to_string(recordLine) + ": " + reason);
+        }
+    }
+}
+
+// Pipelined import for very large files: a reader thread cuts the file into
+// record-aligned chunks, worker threads tokenize and convert them, and this
+// thread is the single SQLite writer. Queues are bounded and the number of
+// chunks in flight is capped, so memory stays flat regardless of file size.
+// Rows are written in file order.
+void importFromCSVParallel(Database& db, const string& filename, unsigned threadCount) {
+    ProfileScope scope(profiler, "importFromCSVParallel");
+    if (threadCount == 0) threadCount = max(1u, thread::hardware_concurrency());
+    cout << "\n--- Importing from " << filename << " (" << threadCount << " parse threads) ---\n";
+    CsvReader reader(filename);
+
+    if (!reader.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return;
+    }
+
+    Statement stmt = db.prepare(importInsertSql);
+    if (!stmt) {
+        cerr << "Error preparing import: " << sqlite3_errmsg(db.handle()) << endl;
+        return;
+    }
+
+    const size_t chunkSize = 4 << 20;
+    const size_t maxInFlight = threadCount * 2 + 2;
+    BoundedQueue<ImportBatch> chunks(threadCount * 2);
+    BoundedQueue<ImportBatch> parsed(maxInFlight);
+    CountingSemaphore inFlight(maxInFlight);
+
+    const StorageProfile* previousProfile = switchStorageProfile(db, db.bulkProfile());
+    auto startTime = chrono::steady_clock::now();
+
+    vector<string_view> header;
+    reader.next(header);
+
+    thread readerThread([&] {
+        size_t sequence = 0;
+        while (true) {
+            ImportBatch batch;
+            inFlight.acquire();
+            if (!reader.nextChunk(batch.text, batch.startLine, chunkSize)) {
+                inFlight.release();
+                break;
+            }
+            batch.sequence = sequence++;
+            if (!chunks.push(move(batch))) break;
+        }
+        chunks.close();
+    });
+
+    vector<thread> workers;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&] {
+            ImportBatch batch;
+            while (chunks.pop(batch)) {
+                parseImportBatch(batch);
+                parsed.push(move(batch));
+            }
+        });
+    }
+    thread closer([&] {
+        for (auto& w : workers) w.join();
+        parsed.close();
+    });
+
+    int successCount = 0;
+    int failCount = 0;
+    int pending = 0;
+    vector<string> rejects;
+    map<size_t, ImportBatch> outOfOrder;
+    size_t nextSequence = 0;
+
+    sqlite3_exec(db.handle(), "BEGIN TRANSACTION;", 0, 0, 0);
+    ImportBatch batch;
+    while (parsed.pop(batch)) {
+        outOfOrder.emplace(batch.sequence, move(batch));
+        for (auto it = outOfOrder.find(nextSequence); it != outOfOrder.end(); it = outOfOrder.find(nextSequence)) {
+            ImportBatch& ready = it->second;
+            failCount += (int)ready.rejects.size();
+            rejects.insert(rejects.end(), ready.rejects.begin(), ready.rejects.end());
+            for (const ImportRow& row : ready.rows) {
+                if (insertImportRow(stmt, row)) {
                     successCount++;
                 }
                 else {
                     failCount++;
+                    rejects.push_back("line " + to_string(row.line) + ": " + sqlite3_errmsg(db.handle()));
                 }
-                sqlite3_finalize(stmt);
+                if (++pending >= importBatchSize) {
+                    sqlite3_exec(db.handle(), "COMMIT; BEGIN TRANSACTION;", 0, 0, 0);
+                    pending = 0;
+                }
+            }
+            outOfOrder.erase(it);
+            nextSequence++;
+            inFlight.release();
+        }
+    }
+    sqlite3_exec(db.handle(), "COMMIT;", 0, 0, 0);
+
+    readerThread.join();
+    closer.join();
+    stmt = Statement();
+    switchStorageProfile(db, previousProfile);
+
+    reportImport(successCount, failCount, rejects, chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+}
 
+// ===================================================================
+// PRICE FEED
+// ===================================================================
+// Reprices the whole inventory from a local CSV feed of
+//   name,setName,cardNumber,condition,price
+// (header row first). The feed is staged into a temp table keyed like the
+// cards it matches, then applied with a single UPDATE ... FROM join, so a
+// large feed costs one pass over each table rather than one UPDATE per card.
+// When a key appears more than once the last line wins.
+
+// Indexes over ebayCompValue and the columns generated from it (migrations
+// 2 and 3); name and definition.
+const char* priceIndexes[][2] = {
+    { "idx_inventory_ebayCompValue", "inventory(ebayCompValue)" },
+    { "idx_inventory_marketValue", "inventory(marketValue)" },
+    { "idx_inventory_potentialProfit", "inventory(potentialProfit)" },
+};
+
+Money dashboardMarketValue(Database& db) {
+    Statement stmt = db.prepare("SELECT totMarketValue FROM dashboard_totals WHERE id = 1;");
+    return sqlite3_step(stmt) == SQLITE_ROW ? columnMoney(stmt, 0) : Money();
+}
+
+void repriceFromFeed(Database& db, const string& filename) {
+    ProfileScope scope(profiler, "repriceFromFeed");
+    cout << "\n--- Repricing from " << filename << " ---\n";
+    CsvReader reader(filename);
+    if (!reader.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return;
+    }
+
+    const StorageProfile* previousProfile = switchStorageProfile(db, db.bulkProfile());
+    auto startTime = chrono::steady_clock::now();
+    // An empty cardNumber or condition in the feed stands for a NULL one in
+    // the inventory, so the staged columns are never NULL.
+    if (!execCached(db, "BEGIN IMMEDIATE;")
+        || sqlite3_exec(db.handle(),
+            "CREATE TEMP TABLE IF NOT EXISTS price_feed ("
+            "name TEXT NOT NULL, setName TEXT NOT NULL, cardNumber TEXT NOT NULL, condition TEXT NOT NULL, price INTEGER NOT NULL,"
+            "PRIMARY KEY (name, setName, cardNumber, condition)) WITHOUT ROWID;"
+            "DELETE FROM temp.price_feed;", 0, 0, 0) != SQLITE_OK) {
+        cerr << "Error starting the repricing transaction: " << sqlite3_errmsg(db.handle()) << endl;
+        if (!sqlite3_get_autocommit(db.handle())) execCached(db, "ROLLBACK;");
+        switchStorageProfile(db, previousProfile);
+        return;
+    }
+
+    int feedLines = 0, failCount = 0;
+    vector<string> rejects;
+    vector<string_view> fields;
+    {
+        Statement stage = db.prepare("INSERT OR REPLACE INTO temp.price_feed (name, setName, cardNumber, condition, price) VALUES (?, ?, ?, ?, ?);");
+        reader.next(fields); // header row
+        Money price;
+        while (reader.next(fields)) {
+            if (fields.size() == 1 && fields[0].empty()) continue; // blank line
+            if (fields.size() != 5) {
+                failCount++;
+                rejects.push_back("line " + to_string(reader.lineNumber()) + ": expected name,setName,cardNumber,condition,price");
+                continue;
             }
-            catch (const std::invalid_argument& e) {
+            if (!parseCsvMoney(fields[4], price) || price < Money()) {
                 failCount++;
+                rejects.push_back("line " + to_string(reader.lineNumber()) + ": bad price '" + string(fields[4]) + "'");
+                continue;
+            }
+            // An empty field can have a null data(), which would bind NULL.
+            for (int i = 0; i < 4; ++i) sqlite3_bind_text(stage, i + 1, fields[i].empty() ? "" : fields[i].data(), (int)fields[i].size(), SQLITE_STATIC);
+            sqlite3_bind_int64(stage, 5, price.cents);
+            if (sqlite3_step(stage) == SQLITE_DONE) feedLines++;
+            else {
+                failCount++;
+                rejects.push_back("line " + to_string(reader.lineNumber()) + ": " + sqlite3_errmsg(db.handle()));
+            }
+            sqlite3_reset(stage);
+        }
+    }
+
+    // Every changed price moves three index entries. When the feed covers a
+    // large part of the inventory it is much cheaper to drop those indexes
+    // and rebuild each with one sorted pass afterwards (same transaction, so
+    // a failure restores them too).
+    int inventoryRows = 0;
+    {
+        Statement count = db.prepare("SELECT COUNT(*) FROM inventory;");
+        if (sqlite3_step(count) == SQLITE_ROW) inventoryRows = sqlite3_column_int(count, 0);
+    }
+    bool rebuildIndexes = feedLines > 10000 && feedLines >= inventoryRows / 10;
+    bool ok = true;
+    if (rebuildIndexes) {
+        for (const auto& index : priceIndexes) {
+            ok = ok && execCached(db, ("DROP INDEX IF EXISTS " + string(index[0]) + ";").c_str());
+        }
+    }
+
+    Money valueBefore = dashboardMarketValue(db);
+    ok = ok && execCached(db,
+        "UPDATE inventory SET ebayCompValue = f.price FROM temp.price_feed AS f "
+        "WHERE inventory.name = f.name AND inventory.setName = f.setName AND IFNULL(inventory.cardNumber, '') = f.cardNumber "
+        "AND IFNULL(inventory.condition, '') = f.condition AND inventory.ebayCompValue IS NOT f.price;");
+    int changed = ok ? sqlite3_changes(db.handle()) : 0;
+    Money valueAfter = dashboardMarketValue(db);
+
+    // Feed lines naming no card, usually a typo in the feed. The unary + on
+    // setName keeps the lookup on idx_inventory_name: a set holds thousands
+    // of rows, a name only a few.
+    int unmatched = 0;
+    if (ok) {
+        Statement count = db.prepare(
+            "SELECT COUNT(*) FROM temp.price_feed AS f WHERE NOT EXISTS (SELECT 1 FROM inventory AS i "
+            "WHERE i.name = f.name AND +i.setName = f.setName AND IFNULL(i.cardNumber, '') = f.cardNumber AND IFNULL(i.condition, '') = f.condition);");
+        if (sqlite3_step(count) == SQLITE_ROW) unmatched = sqlite3_column_int(count, 0);
+    }
+
+    if (rebuildIndexes) {
+        for (const auto& index : priceIndexes) {
+            ok = ok && execCached(db, ("CREATE INDEX IF NOT EXISTS " + string(index[0]) + " ON " + index[1] + ";").c_str());
+        }
+    }
+
+    if (!ok) {
+        cerr << "Error applying price feed: " << sqlite3_errmsg(db.handle()) << endl;
+        execCached(db, "ROLLBACK;");
+    }
+    else execCached(db, "COMMIT;");
+    execCached(db, "DELETE FROM temp.price_feed;");
+    switchStorageProfile(db, previousProfile);
+    if (!ok) return;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "Feed prices read: " << feedLines << "\n";
+    cout << "Feed prices matching no card: " << unmatched << "\n";
+    cout << "Cards repriced: " << changed << "\n";
+    Money change = valueAfter - valueBefore;
+    cout << "Market value change: " << (change >= Money() ? "+$" : "-$") << (change >= Money() ? change : -change)
+        << " (now $" << valueAfter << ")\n";
+    cout << "Elapsed: " << fixed << setprecision(2) << seconds << "s\n";
+    const size_t maxRejectsShown = 25;
+    for (size_t i = 0; i < rejects.size() && i < maxRejectsShown; ++i) cout << "  Rejected " << rejects[i] << "\n";
+    if (rejects.size() > maxRejectsShown) cout << "  ... and " << rejects.size() - maxRejectsShown << " more rejected lines\n";
+}
+
+// ===================================================================
+// DUPLICATE CONSOLIDATION
+// ===================================================================
+// addCard() only merges into an exact match and imports never check, so the
+// same card can end up in many rows. consolidateDuplicates() groups every
+// row by a normalized key in one pass over the table (a hash aggregation,
+// linear in the row count) and folds each group into its oldest row: the
+// quantities are added, purchasePrice becomes the quantity-weighted average
+// and ebayCompValue is taken from the newest copy, as the latest comp.
+
+struct DuplicateGroup {
+    int keepId;
+    int rows;
+    long long quantity;
+    Money cost;          // sum of purchasePrice * quantity
+    Money ebayCompValue; // from the newest row of the group
+    Money keepPrice;     // keeper's purchasePrice, used if the quantities sum to 0
+};
+
+// Appends a field to a duplicate key: trimmed, runs of whitespace collapsed
+// to one space and ASCII letters lowercased, so "Charizard  " and
+// "charizard" group together. Fields are separated by \x1f.
+void appendKeyField(string& key, string_view field) {
+    bool space = false;
+    for (char c : field) {
+        if (isspace((unsigned char)c)) { space = true; continue; }
+        if (space && !key.empty() && key.back() != '\x1f') key += ' ';
+        space = false;
+        key += (char)tolower((unsigned char)c);
+    }
+    key += '\x1f';
+}
+
+int64_t databaseFreeBytes(Database& db) {
+    Statement stmt = db.prepare("SELECT freelist_count * page_size FROM pragma_freelist_count, pragma_page_size;");
+    return sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+}
+
+void consolidateDuplicates(Database& db) {
+    ProfileScope scope(profiler, "consolidateDuplicates");
+    cout << "\n--- Merging duplicate cards ---\n";
+    const StorageProfile* previousProfile = switchStorageProfile(db, db.bulkProfile());
+    auto startTime = chrono::steady_clock::now();
+    // Without the transaction the rewrite would autocommit statement by
+    // statement, so if BEGIN fails (another writer held the lock past the
+    // busy timeout) nothing is merged.
+    if (!execCached(db, "BEGIN IMMEDIATE;")) {
+        cerr << "Error starting the merge transaction: " << sqlite3_errmsg(db.handle()) << endl;
+        switchStorageProfile(db, previousProfile);
+        return;
+    }
+    int64_t freeBefore = databaseFreeBytes(db);
+
+    // Keys live in one arena; the map only holds views into it.
+    StringArena keyText(1 << 20);
+    unordered_map<string_view, DuplicateGroup> groups;
+    vector<int> duplicateIds;
+    size_t scanned = 0;
+    {
+        Statement count = db.prepare("SELECT COUNT(*) FROM inventory;");
+        if (sqlite3_step(count) == SQLITE_ROW) groups.reserve((size_t)sqlite3_column_int64(count, 0));
+    }
+    {
+        Statement stmt = db.prepare("SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory ORDER BY id;");
+        string key;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            scanned++;
+            key.clear();
+            for (int col = 1; col <= 6; ++col) appendKeyField(key, columnView(stmt, col));
+            int id = sqlite3_column_int(stmt, 0);
+            Money price = columnMoney(stmt, 7);
+            Money comp = columnMoney(stmt, 8);
+            int quantity = sqlite3_column_int(stmt, 9);
+
+            auto it = groups.find(key);
+            if (it == groups.end()) {
+                groups.emplace(keyText.store(key.data(), key.size()), DuplicateGroup{ id, 1, quantity, price * quantity, comp, price });
+                continue;
             }
+            DuplicateGroup& group = it->second;
+            group.rows++;
+            group.quantity += quantity;
+            group.cost += price * quantity;
+            group.ebayCompValue = comp;
+            duplicateIds.push_back(id);
+        }
+    }
+
+    // Stage the result, then apply it with one UPDATE and one DELETE.
+    bool ok = sqlite3_exec(db.handle(),
+        "CREATE TEMP TABLE IF NOT EXISTS consolidate_keep (id INTEGER PRIMARY KEY, quantity INTEGER NOT NULL, purchasePrice INTEGER NOT NULL, ebayCompValue INTEGER NOT NULL);"
+        "CREATE TEMP TABLE IF NOT EXISTS consolidate_drop (id INTEGER PRIMARY KEY);"
+        "DELETE FROM temp.consolidate_keep; DELETE FROM temp.consolidate_drop;", 0, 0, 0) == SQLITE_OK;
+    size_t mergedCards = 0;
+    {
+        Statement keep = db.prepare("INSERT INTO temp.consolidate_keep VALUES (?, ?, ?, ?);");
+        for (const auto& entry : groups) {
+            const DuplicateGroup& group = entry.second;
+            if (!ok || group.rows < 2) continue;
+            mergedCards++;
+            sqlite3_reset(keep);
+            sqlite3_bind_int(keep, 1, group.keepId);
+            sqlite3_bind_int64(keep, 2, group.quantity);
+            sqlite3_bind_int64(keep, 3, (group.quantity > 0 ? group.cost.dividedBy(group.quantity) : group.keepPrice).cents);
+            sqlite3_bind_int64(keep, 4, group.ebayCompValue.cents);
+            ok = sqlite3_step(keep) == SQLITE_DONE;
+        }
+        Statement drop = db.prepare("INSERT INTO temp.consolidate_drop VALUES (?);");
+        for (int id : duplicateIds) {
+            if (!ok) break;
+            sqlite3_reset(drop);
+            sqlite3_bind_int(drop, 1, id);
+            ok = sqlite3_step(drop) == SQLITE_DONE;
+        }
+    }
+
+    // Removing a large share of the table is much cheaper with the secondary
+    // indexes dropped and rebuilt in one sorted pass each (as in
+    // repriceFromFeed(); same transaction, so a failure restores them too).
+    vector<string> indexSql;
+    if (ok && duplicateIds.size() > 10000 && duplicateIds.size() >= scanned / 10) {
+        Statement list = db.prepare("SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = 'inventory' AND sql IS NOT NULL;");
+        vector<string> names;
+        while (sqlite3_step(list) == SQLITE_ROW) {
+            names.push_back(string(columnView(list, 0)));
+            indexSql.push_back(string(columnView(list, 1)));
+        }
+        list = Statement();
+        for (const string& name : names) ok = ok && execCached(db, ("DROP INDEX \"" + name + "\";").c_str());
+    }
+    ok = ok && execCached(db,
+        "UPDATE inventory SET quantity = k.quantity, purchasePrice = k.purchasePrice, ebayCompValue = k.ebayCompValue "
+        "FROM temp.consolidate_keep AS k WHERE inventory.id = k.id;");
+    ok = ok && execCached(db, "DELETE FROM inventory WHERE id IN (SELECT id FROM temp.consolidate_drop);");
+    for (const string& sql : indexSql) ok = ok && execCached(db, (sql + ";").c_str());
+    int64_t freeAfter = databaseFreeBytes(db);
+
+    if (!ok) {
+        cerr << "Error merging duplicates: " << sqlite3_errmsg(db.handle()) << endl;
+        execCached(db, "ROLLBACK;");
+    }
+    else execCached(db, "COMMIT;");
+    sqlite3_exec(db.handle(), "DELETE FROM temp.consolidate_keep; DELETE FROM temp.consolidate_drop;", 0, 0, 0);
+    switchStorageProfile(db, previousProfile);
+    if (!ok) return;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "Cards scanned: " << scanned << " (" << groups.size() << " distinct)\n";
+    if (duplicateIds.empty()) cout << "No duplicates found.\n";
+    else {
+        cout << "Merged " << duplicateIds.size() + mergedCards << " rows into " << mergedCards << " cards; "
+            << duplicateIds.size() << " rows removed.\n";
+        cout << "Reclaimed: " << fixed << setprecision(1) << max<int64_t>(0, freeAfter - freeBefore) / 1048576.0
+            << " MB of database pages, now free for reuse.\n";
+    }
+    cout << "Elapsed: " << fixed << setprecision(2) << seconds << "s\n";
+}
+
+// ===================================================================
+// EXPORT
+// ===================================================================
+// Streams a listing query out as CSV or newline-delimited JSON. Column text
+// is copied straight from SQLite's row buffers into one large PageWriter
+// that is written out whenever it fills, so no per-row objects or strings
+// are built and memory stays flat however many rows are exported. Amounts
+// are written in dollars (12.50), as the importer and price feed read them.
+
+bool isMoneyColumn(const char* name) {
+    for (const char* money : { "purchasePrice", "ebayCompValue", "finalSoldPrice", "profitMade" }) {
+        if (strcmp(name, money) == 0) return true;
+    }
+    return false;
+}
+
+bool exportListing(Database& db, const ListingQuery& query, ostream& out, bool json, size_t& rows) {
+    const size_t flushBytes = 1 << 20;
+    Statement stmt = db.prepare(buildPageSql(query, "", false));
+    if (!stmt) return false;
+    bindPageQuery(stmt, query, nullptr, 0, -1);
+
+    // The last result column is the listing's sort key, not part of the row.
+    int columns = sqlite3_column_count(stmt) - 1;
+    PageWriter buffer(flushBytes + 64 * 1024);
+    vector<string> keys;
+    vector<bool> money;
+    for (int col = 0; col < columns; ++col) {
+        money.push_back(isMoneyColumn(sqlite3_column_name(stmt, col)));
+        PageWriter key(64);
+        key << (col == 0 ? "{" : ",");
+        key.json(sqlite3_column_name(stmt, col)) << ":";
+        keys.emplace_back(key.view());
+        if (!json) {
+            if (col) buffer << ",";
+            buffer.csv(sqlite3_column_name(stmt, col));
+        }
+    }
+    if (!json) buffer << "\n";
+
+    rows = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        for (int col = 0; col < columns; ++col) {
+            int type = sqlite3_column_type(stmt, col);
+            if (json) {
+                buffer << keys[col];
+                if (type == SQLITE_NULL) buffer << "null";
+                else if (type == SQLITE_TEXT) buffer.json(columnView(stmt, col));
+                else if (money[col]) buffer.money(columnMoney(stmt, col));
+                else buffer << columnView(stmt, col);
+            }
+            else {
+                if (col) buffer << ",";
+                if (type == SQLITE_TEXT) buffer.csv(columnView(stmt, col));
+                else if (money[col] && type != SQLITE_NULL) buffer.money(columnMoney(stmt, col));
+                else if (type != SQLITE_NULL) buffer << columnView(stmt, col);
+            }
+        }
+        buffer << (json ? "}\n" : "\n");
+        rows++;
+        if (buffer.size() >= flushBytes) buffer.flush(out);
+    }
+    buffer.flush(out);
+    return rc == SQLITE_DONE && out.good();
+}
+
+// Exports a whole table, or the rows of one listing mode ("where" is the
+// printInventory()/printSalesLog() menu number, with ":term" for searches).
+void runExport(Database& db, const string& table, const string& path, bool json, const string& where) {
+    int mode = table == "inventory" ? 6 : 3; // newest first
+    string term;
+    if (!where.empty()) {
+        size_t colon = where.find(':');
+        mode = atoi(where.substr(0, colon).c_str());
+        if (colon != string::npos) term = where.substr(colon + 1);
+    }
+    if (mode < 1 || mode > (table == "inventory" ? 9 : 5)) {
+        cerr << "Invalid --where mode for " << table << ": " << where << endl;
+        return;
+    }
+    ListingQuery query = table == "inventory" ? inventoryListingQuery(db, mode, term) : salesListingQuery(db, mode, term);
+
+    ofstream file;
+    if (path != "-") {
+        file.open(path, ios::binary);
+        if (!file) { cerr << "Error: Could not open " << path << " for writing\n"; return; }
+    }
+    ostream& out = path == "-" ? cout : file;
+
+    auto startTime = chrono::steady_clock::now();
+    size_t rows = 0;
+    if (!exportListing(db, query, out, json, rows)) {
+        cerr << "Export failed after " << rows << " rows: " << sqlite3_errmsg(db.handle()) << endl;
+        return;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cerr << "Exported " << rows << " " << table << " rows in " << fixed << setprecision(2) << seconds << "s\n";
+}
+
+// Asks what to export and runs it on a worker thread with its own read
+// connection, so the menu stays usable (edits included) while it runs.
+void exportInBackground(ConnectionPool& pool, vector<thread>& workers) {
+    string table, path, format;
+    cout << "Export which table (inventory/sales)? ";
+    cin >> table;
+    if (table != "inventory" && table != "sales") { cout << "Unknown table.\n"; return; }
+    cout << "Format (csv/ndjson)? ";
+    cin >> format;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    cout << "Output file (blank for " << table << (format == "ndjson" ? ".ndjson" : ".csv") << "): ";
+    getline(cin, path);
+    path = trim(path);
+    if (path.empty()) path = table + (format == "ndjson" ? ".ndjson" : ".csv");
+
+    // Without a read pool the export would share the writer's connection
+    // (and its statement cache) with this thread, so run it here instead.
+    // The same goes for a rollback-journal session: the export's read lock
+    // would hold off every write, and a reader that touches the file while
+    // an import or repricing has switched to WAL keeps it from switching
+    // back until that connection closes.
+    const StorageProfile* profile = pool.writer().profile();
+    bool wal = strcmp(profile->journalMode, "WAL") == 0;
+    if (pool.readerCount() == 0 || !wal) {
+        if (!wal) cout << "The " << profile->name << " profile has no WAL, so the export runs in the foreground.\n";
+        runExport(pool.writer(), table, path, format == "ndjson", "");
+        return;
+    }
+    workers.emplace_back([&pool, table, path, format] {
+        auto reader = pool.awaitReader();
+        runExport(*reader, table, path, format == "ndjson", "");
+    });
+    cout << "Export started; a line is printed when it finishes.\n";
+}
+
+// ===================================================================
+// BATCH MODE
+// ===================================================================
+// Runs a script of operations without the menu, one CSV record per command:
+//   add,type,name,setName,cardNumber,condition,reference,purchasePrice,ebayCompValue,quantity
+//   sell,cardId,quantity,pricePerCard
+//   edit,cardId,field,value
+//   delete,cardId
+//   delete-sale,saleId
+//   search,inventory|sales,term[,limit]
+// Blank lines and lines starting with '#' are skipped. Each command runs in
+// its own savepoint inside a transaction committed every batchSize commands,
+// and reports one JSON object per line on stdout.
+
+bool execCached(Database& db, const char* sql) {
+    Statement stmt = db.prepare(sql);
+    return stmt && sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool loadCardById(Database& db, int id, CardCollection& card) {
+    Statement stmt = db.prepare("SELECT id, type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue, quantity FROM inventory WHERE id = ?;");
+    sqlite3_bind_int(stmt, 1, id);
+    if (sqlite3_step(stmt) != SQLITE_ROW) return false;
+    card.id = sqlite3_column_int(stmt, 0);
+    card.type = string(columnView(stmt, 1));
+    card.name = string(columnView(stmt, 2));
+    card.setName = string(columnView(stmt, 3));
+    card.year = 0;
+    card.cardNumber = string(columnView(stmt, 4));
+    card.condition = string(columnView(stmt, 5));
+    card.reference = string(columnView(stmt, 6));
+    card.purchasePrice = columnMoney(stmt, 7);
+    card.ebayCompValue = columnMoney(stmt, 8);
+    card.quantity = sqlite3_column_int(stmt, 9);
+    return true;
+}
+
+bool batchAdd(Database& db, const vector<string_view>& f, PageWriter& detail, string& error) {
+    if (f.size() != 10) { error = "add expects 9 arguments"; return false; }
+    Money purchasePrice, ebayCompValue;
+    int quantity;
+    if (!parseCsvMoney(f[7], purchasePrice) || !parseCsvMoney(f[8], ebayCompValue) || !parseCsvInt(f[9], quantity) || quantity <= 0) {
+        error = "bad price or quantity";
+        return false;
+    }
+
+    Statement stmt = db.prepare("SELECT id, quantity FROM inventory WHERE type = ? AND name = ? AND setName = ? AND condition = ? AND reference = ?;");
+    sqlite3_bind_text(stmt, 1, f[1].data(), (int)f[1].size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, f[2].data(), (int)f[2].size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, f[3].data(), (int)f[3].size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, f[5].data(), (int)f[5].size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, f[6].data(), (int)f[6].size(), SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        int newQuantity = sqlite3_column_int(stmt, 1) + quantity;
+        stmt = db.prepare("UPDATE inventory SET quantity = ? WHERE id = ?;");
+        sqlite3_bind_int(stmt, 1, newQuantity);
+        sqlite3_bind_int(stmt, 2, id);
+        if (sqlite3_step(stmt) != SQLITE_DONE) { error = sqlite3_errmsg(db.handle()); return false; }
+        detail << ",\"id\":" << id << ",\"quantity\":" << newQuantity << ",\"merged\":true";
+        return true;
+    }
+
+    ImportRow row{ 0, f[1], f[2], f[3], f[4], f[5], f[6], purchasePrice, ebayCompValue, quantity };
+    stmt = db.prepare(importInsertSql);
+    if (!insertImportRow(stmt, row)) { error = sqlite3_errmsg(db.handle()); return false; }
+    detail << ",\"id\":" << (int)sqlite3_last_insert_rowid(db.handle()) << ",\"quantity\":" << quantity << ",\"merged\":false";
+    return true;
+}
+
+bool batchSell(Database& db, const vector<string_view>& f, PageWriter& detail, string& error) {
+    int id, quantity;
+    Money price;
+    if (f.size() != 4 || !parseCsvInt(f[1], id) || !parseCsvInt(f[2], quantity) || !parseCsvMoney(f[3], price)) {
+        error = "sell expects cardId,quantity,pricePerCard";
+        return false;
+    }
+    CardCollection card;
+    if (!loadCardById(db, id, card)) { error = "no card with id " + to_string(id); return false; }
+    if (quantity <= 0 || quantity > card.quantity || price < Money()) {
+        error = "invalid quantity or price (have " + to_string(card.quantity) + ")";
+        return false;
+    }
+    sqlite3_int64 saleId = 0;
+    if (!recordSale(db, card, quantity, price, &saleId)) { error = sqlite3_errmsg(db.handle()); return false; }
+    detail << ",\"saleId\":" << (int)saleId << ",\"remaining\":" << card.quantity - quantity;
+    return true;
+}
+
+bool batchEdit(Database& db, const vector<string_view>& f, PageWriter& detail, string& error) {
+    int id;
+    if (f.size() != 4 || !parseCsvInt(f[1], id)) { error = "edit expects cardId,field,value"; return false; }
+
+    static const char* textFields[] = { "type", "name", "setName", "cardNumber", "condition", "reference" };
+    string field(f[2]);
+    Statement stmt;
+    for (const char* name : textFields) {
+        if (field == name) {
+            stmt = db.prepare("UPDATE inventory SET " + field + " = ? WHERE id = ?;");
+            sqlite3_bind_text(stmt, 1, f[3].data(), (int)f[3].size(), SQLITE_STATIC);
+        }
+    }
+    if (field == "purchasePrice" || field == "ebayCompValue") {
+        Money value;
+        if (!parseCsvMoney(f[3], value)) { error = "bad amount '" + string(f[3]) + "'"; return false; }
+        stmt = db.prepare("UPDATE inventory SET " + field + " = ? WHERE id = ?;");
+        sqlite3_bind_int64(stmt, 1, value.cents);
+    }
+    else if (field == "quantity") {
+        int value;
+        if (!parseCsvInt(f[3], value) || value < 0) { error = "bad quantity '" + string(f[3]) + "'"; return false; }
+        stmt = db.prepare("UPDATE inventory SET quantity = ? WHERE id = ?;");
+        sqlite3_bind_int(stmt, 1, value);
+    }
+    if (!stmt) { error = "unknown field '" + field + "'"; return false; }
+
+    sqlite3_bind_int(stmt, 2, id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) { error = sqlite3_errmsg(db.handle()); return false; }
+    if (sqlite3_changes(db.handle()) == 0) { error = "no card with id " + to_string(id); return false; }
+    detail << ",\"id\":" << id;
+    return true;
+}
+
+bool batchDelete(Database& db, const vector<string_view>& f, const char* sql, PageWriter& detail, string& error) {
+    int id;
+    if (f.size() != 2 || !parseCsvInt(f[1], id)) { error = "expected a single id"; return false; }
+    Statement stmt = db.prepare(sql);
+    sqlite3_bind_int(stmt, 1, id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) { error = sqlite3_errmsg(db.handle()); return false; }
+    if (sqlite3_changes(db.handle()) == 0) { error = "no row with id " + to_string(id); return false; }
+    detail << ",\"id\":" << id;
+    return true;
+}
+
+bool batchSearch(Database& db, const vector<string_view>& f, PageWriter& detail, string& error) {
+    int limit = 50;
+    if (f.size() < 3 || f.size() > 4 || (f.size() == 4 && !parseCsvInt(f[3], limit))) {
+        error = "search expects inventory|sales,term[,limit]";
+        return false;
+    }
+    bool inventory = f[1] == "inventory";
+    if (!inventory && f[1] != "sales") { error = "search target must be inventory or sales"; return false; }
+
+    string term(f[2]);
+    string match = buildFtsQuery("name", term);
+    Statement stmt;
+    if (inventory) {
+        if (!match.empty() && tableExists(db, "inventory_fts")) {
+            stmt = db.prepare("SELECT inventory.id, inventory.name, inventory.setName, inventory.quantity FROM inventory_fts JOIN inventory ON inventory.id = inventory_fts.rowid WHERE inventory_fts MATCH ? ORDER BY inventory_fts.rank LIMIT ?;");
         }
         else {
-            failCount++;
+            stmt = db.prepare("SELECT id, name, setName, quantity FROM inventory WHERE name LIKE ? ORDER BY name LIMIT ?;");
+            match = "%" + term + "%";
+        }
+    }
+    else {
+        if (!match.empty() && tableExists(db, "sales_fts")) {
+            stmt = db.prepare("SELECT sales.id, sales.name, sales.setName, sales.quantitySold FROM sales_fts JOIN sales ON sales.id = sales_fts.rowid WHERE sales_fts MATCH ? ORDER BY sales_fts.rank LIMIT ?;");
+        }
+        else {
+            stmt = db.prepare("SELECT id, name, setName, quantitySold FROM sales WHERE name LIKE ? ORDER BY name LIMIT ?;");
+            match = "%" + term + "%";
         }
     }
+    sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, limit);
 
-    inputFile.close();
-    cout << "Import complete.\nSuccessfully imported " << successCount << " cards.\nFailed to import " << failCount << " rows.\n";
+    detail << ",\"results\":[";
+    bool first = true;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        detail << (first ? "" : ",") << "{\"id\":" << sqlite3_column_int(stmt, 0) << ",\"name\":";
+        detail.json(columnView(stmt, 1)) << ",\"setName\":";
+        detail.json(columnView(stmt, 2)) << ",\"quantity\":" << sqlite3_column_int(stmt, 3) << "}";
+        first = false;
+    }
+    detail << "]";
+    return true;
+}
+
+void runBatch(Database& db, const string& script, int batchSize) {
+    ProfileScope scope(profiler, "runBatch");
+    CsvReader reader = script == "-" ? CsvReader(cin) : CsvReader(script);
+    if (!reader.is_open()) {
+        cerr << "Error: Could not open batch script " << script << endl;
+        return;
+    }
+
+    const StorageProfile* previousProfile = switchStorageProfile(db, db.bulkProfile());
+    auto startTime = chrono::steady_clock::now();
+    PageWriter out;
+    PageWriter detail(4096);
+    vector<string_view> fields;
+    string error;
+    int commands = 0, succeeded = 0, failed = 0, pending = 0;
+
+    execCached(db, "BEGIN TRANSACTION;");
+    while (reader.next(fields)) {
+        if (fields.empty() || (fields.size() == 1 && fields[0].empty())) continue;
+        if (!fields[0].empty() && fields[0][0] == '#') continue;
+
+        string_view op = fields[0];
+        detail.clear();
+        error.clear();
+        commands++;
+
+        execCached(db, "SAVEPOINT batch_command;");
+        bool ok;
+        if (op == "add") ok = batchAdd(db, fields, detail, error);
+        else if (op == "sell") ok = batchSell(db, fields, detail, error);
+        else if (op == "edit") ok = batchEdit(db, fields, detail, error);
+        else if (op == "delete") ok = batchDelete(db, fields, "DELETE FROM inventory WHERE id = ?;", detail, error);
+        else if (op == "delete-sale") ok = batchDelete(db, fields, "DELETE FROM sales WHERE id = ?;", detail, error);
+        else if (op == "search") ok = batchSearch(db, fields, detail, error);
+        else { ok = false; error = "unknown command"; }
+        if (!ok) {
+            execCached(db, "ROLLBACK TO batch_command;");
+            changeCapture.invalidate();
+        }
+        execCached(db, "RELEASE batch_command;");
+
+        out << "{\"line\":" << (int)reader.lineNumber() << ",\"op\":";
+        out.json(op) << ",\"ok\":" << (ok ? "true" : "false");
+        if (ok) out << detail.view();
+        else { out << ",\"error\":"; out.json(error); }
+        out << "}\n";
+        ok ? succeeded++ : failed++;
+
+        if (++pending >= batchSize) {
+            execCached(db, "COMMIT;");
+            execCached(db, "BEGIN TRANSACTION;");
+            out.flush();
+            pending = 0;
+        }
+    }
+    execCached(db, "COMMIT;");
+    switchStorageProfile(db, previousProfile);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    char elapsed[32];
+    snprintf(elapsed, sizeof(elapsed), "%.3f", seconds);
+    out << "{\"op\":\"summary\",\"commands\":" << commands << ",\"ok\":" << succeeded
+        << ",\"failed\":" << failed << ",\"seconds\":" << elapsed << "}\n";
+    out.flush();
 }
 
+// ===================================================================
+// BENCHMARK MODE
+// ===================================================================
+// Times the hot paths one at a time against a generated collection in a
+// scratch database (bench.db), so a change can be checked for regressions
+// before it meets a real inventory. Every timed operation is repeated and
+// reported as latency percentiles plus throughput.
+
+// Prints one result line. samples holds seconds per run; itemsPerSample is
+// what one run processes (rows loaded, rows on a page, sales recorded).
+void reportBenchmark(const char* name, vector<double>& samples, double itemsPerSample) {
+    if (samples.empty()) return;
+    sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        size_t rank = (size_t)ceil(p * samples.size());
+        return samples[rank > 0 ? rank - 1 : 0] * 1000.0;
+    };
+    double total = 0;
+    for (double s : samples) total += s;
+    char line[160];
+    snprintf(line, sizeof(line), "%-28s %7zu %10.3f %10.3f %10.3f %10.3f %14.0f\n",
+        name, samples.size(), percentile(0.50), percentile(0.95), percentile(0.99), samples.back() * 1000.0,
+        total > 0 ? itemsPerSample * samples.size() / total : 0.0);
+    cout << line;
+}
+
+// Runs fn() `runs` times and returns the wall time of each run in seconds.
+template <typename Fn>
+vector<double> timeRuns(int runs, Fn fn) {
+    vector<double> samples;
+    samples.reserve(runs);
+    for (int i = 0; i < runs; ++i) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    return samples;
+}
+
+// Largest --bench collection; 10m rows already make a multi-GB scratch
+// database and CSV.
+const unsigned long long maxBenchRows = 10000000;
+
+// Reads a --bench row count such as "50000", "10k" or "1m". Anything else,
+// including zero, an overflowing count and one above maxBenchRows, is
+// rejected so a typo cannot fall through to the real database or fill the
+// disk.
+bool parseRowCount(const char* text, size_t& rows) {
+    if (!isdigit((unsigned char)text[0])) return false;
+    char* suffix = nullptr;
+    errno = 0;
+    unsigned long long count = strtoull(text, &suffix, 10);
+    if (errno == ERANGE) return false;
+    unsigned long long multiplier = 1;
+    if (*suffix == 'k' || *suffix == 'K') { multiplier = 1000; suffix++; }
+    else if (*suffix == 'm' || *suffix == 'M') { multiplier = 1000000; suffix++; }
+    if (*suffix != '\0' || count == 0 || count > maxBenchRows / multiplier) return false;
+    rows = (size_t)(count * multiplier);
+    return true;
+}
+
+void runBenchmark(Database& db, size_t rows, int runs) {
+    const string csvPath = "bench_cards.csv";
+    cout << "Benchmark: " << rows << " cards, " << runs << " runs per operation, profile "
+        << db.profile()->name << " (bulk: " << db.bulkProfile()->name << ")\n";
+    char header[160];
+    snprintf(header, sizeof(header), "%-28s %7s %10s %10s %10s %10s %14s\n",
+        "operation", "runs", "p50 ms", "p95 ms", "p99 ms", "max ms", "items/sec");
+    cout << header;
+
+    SyntheticCollection generator;
+    vector<double> samples = timeRuns(1, [&] {
+        ofstream csv(csvPath, ios::binary);
+        generator.writeCsv(csv, rows);
+    });
+    reportBenchmark("generate csv", samples, (double)rows);
+
+    // importFromCSV reports to the console; keep that out of the table.
+    ostringstream importLog;
+    streambuf* console = cout.rdbuf(importLog.rdbuf());
+    samples = timeRuns(1, [&] { importFromCSV(db, csvPath); });
+    cout.rdbuf(console);
+    reportBenchmark("importFromCSV", samples, (double)rows);
+    remove(csvPath.c_str());
+
+    // Loading the inventory model three ways: every row through SQL, from
+    // a current snapshot file, and when the model is already current.
+    InventoryModel inventory;
+    samples = timeRuns(runs, [&] { readInventoryRows(inventory, db); });
+    reportBenchmark("loadInventory: sql", samples, (double)inventory.size());
+    string inventorySnapshot = snapshotPath(db, "inventory");
+    inventory.stamp = readSnapshotStamp(db, "inventory");
+    samples = timeRuns(1, [&] { writeInventorySnapshot(inventory, inventorySnapshot); });
+    reportBenchmark("write inventory snapshot", samples, (double)inventory.size());
+    samples = timeRuns(runs, [&] { inventory.clear(); loadInventory(inventory, db); });
+    reportBenchmark("loadInventory: snapshot", samples, (double)inventory.size());
+    samples = timeRuns(runs, [&] { loadInventory(inventory, db); });
+    reportBenchmark("loadInventory: unchanged", samples, (double)inventory.size());
+
+    // One card edited between loads: only that row is read back.
+    samples.clear();
+    for (int i = 0; i < runs; ++i) {
+        {
+            Statement edit = db.prepare("UPDATE inventory SET quantity = quantity + 1 WHERE id = ?;");
+            sqlite3_bind_int64(edit, 1, (sqlite3_int64)(generator.next() % rows) + 1);
+            sqlite3_step(edit);
+        }
+        auto start = chrono::steady_clock::now();
+        loadInventory(inventory, db);
+        samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    reportBenchmark("loadInventory: after edit", samples, 1.0);
+
+    // The card picker: indexing the names once per full load, then one
+    // search per keystroke, for a prefix and for queries with typos. The
+    // 4- and 8-character ones are a single typo away from a type name and
+    // must find it; a miss is reported rather than timed.
+    samples = timeRuns(1, [&] { inventory.names.clear(); buildNameIndex(inventory); });
+    reportBenchmark("pick: build name index", samples, (double)inventory.size());
+    const char* pickQueries[][2] = { { "pick: prefix", "Player 42" }, { "pick: typos", "Baseball Plyer 4217" },
+        { "pick: 4-char typo", "hpck" }, { "pick: 8-char typo", "basebsll" } };
+    for (const auto& pick : pickQueries) {
+        size_t found = 0;
+        samples = timeRuns(runs * 20, [&] { found = pickCandidates(inventory, pick[1], 10).size(); });
+        if (found == 0) cout << pick[0] << ": no match for '" << pick[1] << "'\n";
+        else reportBenchmark(pick[0], samples, (double)found);
+    }
+
+    // First page of every printInventory() mode, rendered but not printed.
+    const char* listingNames[] = { "", "list: name search", "list: name A-Z", "list: highest value",
+        "list: potential profit", "list: set search", "list: newest first", "list: type",
+        "list: reference search", "list: market value" };
+    const char* searchTerms[] = { "", "Player 42", "", "", "", "Baseball 1", "", "", "R12", "" };
+    PageWriter page;
+    for (int mode = 1; mode <= 9; ++mode) {
+        ListingQuery query = inventoryListingQuery(db, mode, searchTerms[mode]);
+        string sql = buildPageSql(query, "", false);
+        int rowsOnPage = 0;
+        samples = timeRuns(runs, [&] {
+            Statement stmt = db.prepare(sql);
+            bindPageQuery(stmt, query, nullptr, 0, 20);
+            rowsOnPage = 0;
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                displayCardDetails(page, stmt);
+                rowsOnPage++;
+            }
+            page.clear();
+        });
+        reportBenchmark(listingNames[mode], samples, (double)rowsOnPage);
+    }
+
+    // The sell path from editCard(): one autocommitted recordSale() per sale
+    // on a random card. Fetching the card is not part of the timing.
+    size_t saleCount = max<size_t>(1, min<size_t>(rows / 10, (size_t)runs * 200));
+    samples.clear();
+    CardCollection card;
+    for (size_t i = 0; i < saleCount; ++i) {
+        int id = (int)(generator.next() % rows) + 1;
+        if (!loadCardById(db, id, card)) continue;
+        auto start = chrono::steady_clock::now();
+        recordSale(db, card, 1, card.ebayCompValue);
+        samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    reportBenchmark("recordSale", samples, 1.0);
+
+    // Bring the sales log up to scale (about one sale per four cards) before
+    // timing its load; these rows are derived from inventory and not timed.
+    execCached(db, "BEGIN TRANSACTION;");
+    execCached(db, "INSERT INTO sales (type, name, setName, cardNumber, condition, reference, purchasePrice, finalSoldPrice, profitMade, quantitySold, soldAt) "
+        "SELECT type, name, setName, cardNumber, condition, reference, purchasePrice, ebayCompValue * (8 + id % 5) / 10, "
+        "ebayCompValue * (8 + id % 5) / 10 - purchasePrice, 1, datetime('now', 'localtime', '-' || (id % 1095) || ' days') FROM inventory WHERE id % 4 = 0;");
+    execCached(db, "COMMIT;");
+
+    SalesModel sales;
+    samples = timeRuns(runs, [&] { readSalesRows(sales, db); });
+    reportBenchmark("loadSalesLog: sql", samples, (double)sales.size());
+    string salesSnapshot = snapshotPath(db, "sales");
+    sales.stamp = readSnapshotStamp(db, "sales");
+    writeSalesSnapshot(sales, salesSnapshot);
+    samples = timeRuns(runs, [&] { sales.clear(); loadSalesLog(sales, db); });
+    reportBenchmark("loadSalesLog: snapshot", samples, (double)sales.size());
+}
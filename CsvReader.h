@@ -0,0 +1,176 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Money.h"
+
+// Finds the end of the CSV record that starts at begin (RFC 4180: a newline
+// inside a quoted field does not end the record). Returns a pointer to the
+// record's terminating '\n', or nullptr if the record runs past end.
+inline const char* findCsvRecordEnd(const char* begin, const char* end) {
+    bool inQuotes = false;
+    for (const char* p = begin; p < end; ++p) {
+        if (*p == '"') inQuotes = !inQuotes;
+        else if (*p == '\n' && !inQuotes) return p;
+    }
+    return nullptr;
+}
+
+// Trims spaces, tabs and line endings from both sides of a field.
+inline std::string_view trimView(std::string_view sv) {
+    size_t first = sv.find_first_not_of(" \t\n\r");
+    if (first == std::string_view::npos) return std::string_view();
+    size_t last = sv.find_last_not_of(" \t\n\r");
+    return sv.substr(first, last - first + 1);
+}
+
+// Splits one record in [begin, end) into fields. Quoted fields are unescaped
+// in place ("" becomes ") so every field is a view into the caller's buffer
+// and no per-field allocation happens. Unquoted fields are trimmed.
+inline void splitCsvRecord(char* begin, char* end, std::vector<std::string_view>& fields) {
+    fields.clear();
+    if (end > begin && end[-1] == '\r') --end;
+    char* p = begin;
+    while (true) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (p < end && *p == '"') {
+            char* out = ++p;
+            char* fieldStart = out;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') { *out++ = '"'; p += 2; continue; }
+                    ++p;
+                    break;
+                }
+                *out++ = *p++;
+            }
+            fields.emplace_back(fieldStart, out - fieldStart);
+            while (p < end && *p != ',') ++p;
+        }
+        else {
+            char* fieldStart = p;
+            while (p < end && *p != ',') ++p;
+            fields.push_back(trimView(std::string_view(fieldStart, p - fieldStart)));
+        }
+        if (p >= end) break;
+        ++p; // skip ','
+    }
+}
+
+inline bool parseCsvInt(std::string_view sv, int& out) {
+    sv = trimView(sv);
+    if (sv.empty()) return false;
+    auto res = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    return res.ec == std::errc() && res.ptr == sv.data() + sv.size();
+}
+
+// Accepts an optional leading '$' so exported spreadsheet prices parse as-is.
+// Parsed as exact cents; see parseMoney().
+inline bool parseCsvMoney(std::string_view sv, Money& out) {
+    return parseMoney(trimView(sv), out);
+}
+
+// Streams records out of a CSV file through one large reusable buffer.
+// Fields handed out by next() point into that buffer and stay valid only
+// until the following call.
+class CsvReader {
+public:
+    explicit CsvReader(const std::string& filename, size_t blockSize = 1 << 20)
+        : file(filename, std::ios::binary), in(&file), buffer(blockSize) {}
+
+    // Reads from an already open stream such as std::cin.
+    explicit CsvReader(std::istream& stream, size_t blockSize = 1 << 20)
+        : in(&stream), buffer(blockSize) {}
+
+    // Holds a pointer to its own stream member, so it must stay in place.
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool is_open() const { return in != &file || file.is_open(); }
+
+    // Line number (1-based) of the first line of the record last returned.
+    size_t lineNumber() const { return recordLine; }
+
+    bool next(std::vector<std::string_view>& fields) {
+        while (true) {
+            const char* recordEnd = findCsvRecordEnd(buffer.data() + pos, buffer.data() + filled);
+            if (recordEnd || (eof && pos < filled)) {
+                char* begin = buffer.data() + pos;
+                char* end = recordEnd ? const_cast<char*>(recordEnd) : buffer.data() + filled;
+                pos = recordEnd ? (recordEnd - buffer.data()) + 1 : filled;
+                recordLine = nextLine;
+                nextLine += 1 + std::count(begin, end, '\n');
+                if (recordLine == 1 && end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) begin += 3;
+                splitCsvRecord(begin, end, fields);
+                return true;
+            }
+            if (eof) return false;
+            refill();
+        }
+    }
+
+    // Hands out roughly chunkSize bytes ending on a record boundary, for
+    // callers that parse records on other threads. startLine is the line
+    // number of the chunk's first record.
+    bool nextChunk(std::vector<char>& out, size_t& startLine, size_t chunkSize) {
+        while (true) {
+            if (filled - pos >= chunkSize || eof) {
+                const char* begin = buffer.data() + pos;
+                const char* end = buffer.data() + filled;
+                const char* cut = end;
+                if (!eof || filled - pos > chunkSize) {
+                    const char* lastBreak = nullptr;
+                    bool inQuotes = false;
+                    for (const char* p = begin; p < end; ++p) {
+                        if (*p == '"') inQuotes = !inQuotes;
+                        else if (*p == '\n' && !inQuotes) {
+                            lastBreak = p;
+                            if (p - begin >= static_cast<std::ptrdiff_t>(chunkSize)) break;
+                        }
+                    }
+                    if (lastBreak) cut = lastBreak + 1;
+                    else if (!eof) { refill(); continue; }
+                }
+                if (cut == begin) return false;
+                out.assign(begin, cut);
+                pos = cut - buffer.data();
+                startLine = nextLine;
+                nextLine += std::count(out.begin(), out.end(), '\n');
+                return true;
+            }
+            refill();
+        }
+    }
+
+private:
+    // Moves the unconsumed tail to the front and reads the next block,
+    // growing the buffer when a single record is larger than it.
+    void refill() {
+        size_t remaining = filled - pos;
+        if (remaining > 0 && pos > 0) std::memmove(buffer.data(), buffer.data() + pos, remaining);
+        pos = 0;
+        filled = remaining;
+        if (filled == buffer.size()) buffer.resize(buffer.size() * 2);
+        in->read(buffer.data() + filled, buffer.size() - filled);
+        filled += static_cast<size_t>(in->gcount());
+        if (!*in) eof = true;
+    }
+
+    std::ifstream file;
+    std::istream* in;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t filled = 0;
+    bool eof = false;
+    size_t recordLine = 0;
+    size_t nextLine = 1;
+};
+
+#endif // CSVREADER_H
@@ -0,0 +1,101 @@
+#ifndef DATABASE_H
+#define DATABASE_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "sqlite3.h"
+#include "StorageProfile.h"
+
+// A statement borrowed from Database's cache. It converts to sqlite3_stmt*
+// so it can be passed straight to sqlite3_bind_* / sqlite3_step / sqlite3_column_*.
+// When it goes out of scope the statement is reset (releasing any read lock
+// it holds) and returned to the cache; never sqlite3_finalize() it.
+class Statement {
+public:
+    Statement() = default;
+    explicit Statement(sqlite3_stmt* stmt) : stmt(stmt) {}
+    Statement(Statement&& other) noexcept : stmt(std::exchange(other.stmt, nullptr)) {}
+    Statement& operator=(Statement&& other) noexcept {
+        if (this != &other) {
+            release();
+            stmt = std::exchange(other.stmt, nullptr);
+        }
+        return *this;
+    }
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+    ~Statement() { release(); }
+
+    operator sqlite3_stmt*() const { return stmt; }
+
+private:
+    void release() {
+        if (stmt) sqlite3_reset(stmt);
+        stmt = nullptr;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+};
+
+// Owns the connection and a cache of prepared statements keyed by SQL text,
+// so each distinct query is compiled once per run instead of on every call.
+class Database {
+public:
+    Database() = default;
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+    ~Database() { close(); }
+
+    bool open(const char* filename, int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) {
+        return sqlite3_open_v2(filename, &db, flags, NULL) == SQLITE_OK;
+    }
+
+    void close() {
+        for (auto& entry : cache) sqlite3_finalize(entry.second);
+        cache.clear();
+        if (db) sqlite3_close(db);
+        db = nullptr;
+    }
+
+    sqlite3* handle() const { return db; }
+
+    // Returns a reset statement with cleared bindings, compiling it on first
+    // use. Converts to nullptr if the SQL fails to prepare.
+    Statement prepare(const std::string& sql) {
+        auto it = cache.find(sql);
+        if (it != cache.end()) {
+            sqlite3_reset(it->second);
+            sqlite3_clear_bindings(it->second);
+            return Statement(it->second);
+        }
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL) != SQLITE_OK) {
+            sqlite3_finalize(stmt);
+            return Statement();
+        }
+        cache.emplace(sql, stmt);
+        return Statement(stmt);
+    }
+
+    // Storage profile currently applied to the connection, and the one bulk
+    // paths (CSV import, batch mode) switch to while they run.
+    const StorageProfile* profile() const { return activeProfile; }
+    void setProfile(const StorageProfile* p) { activeProfile = p; }
+    const StorageProfile* bulkProfile() const { return bulk; }
+    void setBulkProfile(const StorageProfile* p) { bulk = p; }
+
+    // Drops every cached statement, e.g. before DDL that would invalidate them.
+    void clearCache() {
+        for (auto& entry : cache) sqlite3_finalize(entry.second);
+        cache.clear();
+    }
+
+private:
+    sqlite3* db = nullptr;
+    const StorageProfile* activeProfile = nullptr;
+    const StorageProfile* bulk = nullptr;
+    std::unordered_map<std::string, sqlite3_stmt*> cache;
+};
+
+#endif // DATABASE_H
@@ -0,0 +1,34 @@
+#ifndef IMPORTBATCH_H
+#define IMPORTBATCH_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Money.h"
+
+// One validated CSV row ready to bind. The text fields point into the
+// buffer of the batch (or reader) that produced them.
+struct ImportRow {
+    size_t line;
+    std::string_view type;
+    std::string_view name;
+    std::string_view setName;
+    std::string_view cardNumber;
+    std::string_view condition;
+    std::string_view reference;
+    Money purchasePrice;
+    Money ebayCompValue;
+    int quantity;
+};
+
+// A record-aligned slice of an import file and the rows parsed out of it.
+struct ImportBatch {
+    size_t sequence = 0;
+    size_t startLine = 1;
+    std::vector<char> text; // owns the bytes every row in this batch points into
+    std::vector<ImportRow> rows;
+    std::vector<std::string> rejects;
+};
+
+#endif // IMPORTBATCH_H
@@ -0,0 +1,19 @@
+#ifndef LISTINGQUERY_H
+#define LISTINGQUERY_H
+
+#include <string>
+
+// Describes one sorted/filtered listing for runPagedListing(). Pages are
+// fetched by keyset: each page continues from the (sortKey, idColumn) of the
+// last row shown, so page N costs the same as page 1.
+struct ListingQuery {
+    std::string columns;     // select list; the row formatter reads these by index
+    std::string from;        // FROM clause, including any JOIN
+    std::string filter;      // WHERE condition, empty for none; may hold one '?' bound to filterValue
+    std::string filterValue;
+    std::string sortKey;     // ORDER BY expression
+    std::string idColumn;    // unique tie-breaker appended to the sort
+    bool descending = false;
+};
+
+#endif // LISTINGQUERY_H
@@ -0,0 +1,99 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// An amount of money as a whole number of cents. Prices are stored this way
+// (INTEGER columns since migration 7), so sums over any number of rows are
+// exact, and convert to dollars only for display.
+struct Money {
+    int64_t cents = 0;
+
+    static constexpr Money fromCents(int64_t cents) { return Money{ cents }; }
+
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+    friend Money operator+(Money a, Money b) { return Money{ a.cents + b.cents }; }
+    friend Money operator-(Money a, Money b) { return Money{ a.cents - b.cents }; }
+    friend Money operator-(Money a) { return Money{ -a.cents }; }
+    friend Money operator*(Money a, int64_t n) { return Money{ a.cents * n }; }
+    friend Money operator*(int64_t n, Money a) { return Money{ a.cents * n }; }
+
+    // Share of n, rounded half away from zero to the nearest cent.
+    Money dividedBy(int64_t n) const {
+        if (n < 0) return Money{ -cents }.dividedBy(-n);
+        return Money{ cents >= 0 ? (cents + n / 2) / n : -((-cents + n / 2) / n) };
+    }
+
+    friend bool operator==(Money a, Money b) { return a.cents == b.cents; }
+    friend bool operator!=(Money a, Money b) { return a.cents != b.cents; }
+    friend bool operator<(Money a, Money b) { return a.cents < b.cents; }
+    friend bool operator<=(Money a, Money b) { return a.cents <= b.cents; }
+    friend bool operator>(Money a, Money b) { return a.cents > b.cents; }
+    friend bool operator>=(Money a, Money b) { return a.cents >= b.cents; }
+
+    // "1234.50" / "-0.05", written into buffer (24 bytes is always enough);
+    // returns the length.
+    int format(char* buffer, size_t size) const {
+        uint64_t magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+        return std::snprintf(buffer, size, "%s%llu.%02llu", cents < 0 ? "-" : "",
+            static_cast<unsigned long long>(magnitude / 100), static_cast<unsigned long long>(magnitude % 100));
+    }
+
+    std::string str() const {
+        char buffer[24];
+        return std::string(buffer, format(buffer, sizeof(buffer)));
+    }
+};
+
+// Parses a decimal amount such as "12", "12.5", "-3.07" or "$1,234.56"
+// exactly, without going through double. Digits past the cents are rounded
+// half away from zero. Exponents and other text are rejected.
+inline bool parseMoney(std::string_view text, Money& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) negative = text[i++] == '-';
+    if (i < text.size() && text[i] == '$') ++i;
+    int64_t whole = 0;
+    bool digits = false;
+    for (; i < text.size() && ((text[i] >= '0' && text[i] <= '9') || (text[i] == ',' && digits)); ++i) {
+        if (text[i] == ',') continue;
+        if (whole > (INT64_MAX / 100 - 9) / 10) return false;
+        whole = whole * 10 + (text[i] - '0');
+        digits = true;
+    }
+    int64_t fraction = 0;
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        int places = 0;
+        bool roundUp = false;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++places) {
+            if (places < 2) fraction = fraction * 10 + (text[i] - '0');
+            else if (places == 2) roundUp = text[i] >= '5';
+            digits = true;
+        }
+        if (places < 2) fraction *= places == 1 ? 10 : 100;
+        if (roundUp) fraction++;
+    }
+    if (!digits || i != text.size()) return false;
+    int64_t cents = whole * 100 + fraction;
+    out = Money{ negative ? -cents : cents };
+    return true;
+}
+
+inline std::ostream& operator<<(std::ostream& out, Money value) { return out << value.str(); }
+
+// Reads one whitespace-delimited token as an amount; sets failbit if it is
+// not one, like reading a malformed number.
+inline std::istream& operator>>(std::istream& in, Money& value) {
+    std::string token;
+    if (in >> token && !parseMoney(token, value)) in.setstate(std::ios::failbit);
+    return in;
+}
+
+#endif // MONEY_H
@@ -0,0 +1,303 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "StringPool.h"
+
+// Type-ahead lookup from a partly typed name to the rows carrying it. Names
+// are indexed once per distinct (case- and space-insensitive) spelling, so
+// a search costs the same however many copies of each card there are:
+//   - every word start of every name sits in one sorted array, and a query
+//     is first matched as a prefix of any word by binary search;
+//   - if that finds too few names, candidates that contain, unchanged, one
+//     of a few pieces of the query (found through bigram and trigram
+//     postings) are checked for a match within one or two typos (Myers'
+//     bit-parallel edit distance, so each check is one pass over the name).
+// build() indexes a whole model; add() and remove() keep it current as
+// single rows change.
+class NameIndex {
+public:
+    struct Match {
+        uint32_t name;  // pass to name() / ids()
+        int typos;      // 0 for a prefix match
+    };
+
+    bool built() const { return isBuilt; }
+
+    void clear() {
+        text.clear();
+        entries.clear();
+        byKey.clear();
+        words.clear();
+        sortedWords = 0;
+        grams.clear();
+        isBuilt = false;
+    }
+
+    // Indexes every row of a model (anything with .name and .id) and marks
+    // the index built. Names are resolved in a first pass so that each
+    // name's id list is allocated once, at its final size.
+    template <typename Rows>
+    void build(const Rows& rows) {
+        clear();
+        std::vector<uint32_t> rowEntries;
+        rowEntries.reserve(rows.size());
+        for (const auto& row : rows) rowEntries.push_back(entryFor(row.name));
+        std::vector<uint32_t> counts(entries.size());
+        for (uint32_t entry : rowEntries) counts[entry]++;
+        for (size_t entry = 0; entry < entries.size(); ++entry) entries[entry].ids.reserve(counts[entry]);
+        size_t i = 0;
+        for (const auto& row : rows) entries[rowEntries[i++]].ids.push_back(row.id);
+        sortPendingWords();
+        isBuilt = true;
+    }
+
+    void add(std::string_view name, int id) { entries[entryFor(name)].ids.push_back(id); }
+
+    // A name whose last row is removed stays indexed but is never returned.
+    void remove(std::string_view name, int id) {
+        normalize(name, scratch);
+        auto it = byKey.find(scratch);
+        if (it == byKey.end()) return;
+        std::vector<int>& ids = entries[it->second].ids;
+        auto found = std::find(ids.begin(), ids.end(), id);
+        if (found != ids.end()) ids.erase(found);
+    }
+
+    std::string_view name(uint32_t entry) const { return entries[entry].display; }
+    const std::vector<int>& ids(uint32_t entry) const { return entries[entry].ids; }
+
+    // Up to limit names for query: prefix matches in alphabetical order of
+    // the matching word, then (for queries of four or more characters) names
+    // within one typo, fewest typos first. Two typos are allowed from eight
+    // characters.
+    std::vector<Match> search(std::string_view query, size_t limit) {
+        std::vector<Match> matches;
+        normalize(query, scratch);
+        if (scratch.empty() || limit == 0) return matches;
+        const std::string q = scratch;
+        sortPendingWords();
+        ++searchStamp;
+
+        auto first = std::lower_bound(words.begin(), words.end(), std::string_view(q),
+            [&](const std::pair<uint32_t, uint32_t>& word, std::string_view key) { return suffix(word) < key; });
+        for (auto it = first; it != words.end() && matches.size() < limit; ++it) {
+            std::string_view s = suffix(*it);
+            if (s.compare(0, q.size(), q) != 0) break;
+            Entry& entry = entries[it->first];
+            if (entry.ids.empty() || entry.seen == searchStamp) continue;
+            entry.seen = searchStamp;
+            matches.push_back(Match{ it->first, 0 });
+        }
+
+        int maxTypos = q.size() >= 8 ? 2 : q.size() >= 4 ? 1 : 0;
+        if (matches.size() >= limit || maxTypos == 0 || q.size() > 64) return matches;
+
+        // Each typo spoils at most one of k + 1 disjoint pieces of the query,
+        // so a name within k typos contains at least one piece unchanged, and
+        // with it every bigram and trigram of that piece. Only the postings
+        // of the pieces' rarest grams are scanned, rarest first, and at most
+        // maxChecks names are checked, so even a query whose pieces every name
+        // holds costs the same however many names there are.
+        std::vector<const std::vector<uint32_t>*> lists = pieceLists(q, maxTypos + 1);
+        Pattern pattern(q);
+        std::vector<Match> fuzzy;
+        size_t checks = 0;
+        for (const auto* list : lists) {
+            for (uint32_t candidate : *list) {
+                Entry& entry = entries[candidate];
+                if (entry.seen == searchStamp) continue;
+                entry.seen = searchStamp;
+                if (entry.ids.empty()) continue;
+                if (++checks > maxChecks) break;
+                int typos = pattern.distance(entry.key, maxTypos);
+                if (typos <= maxTypos) fuzzy.push_back(Match{ candidate, typos });
+            }
+            if (checks > maxChecks) break;
+        }
+        // Only the best few are kept, so only those need ordering.
+        size_t wanted = std::min(fuzzy.size(), limit - matches.size());
+        std::partial_sort(fuzzy.begin(), fuzzy.begin() + wanted, fuzzy.end(), [&](const Match& a, const Match& b) {
+            return a.typos != b.typos ? a.typos < b.typos : entries[a.name].key < entries[b.name].key;
+        });
+        matches.insert(matches.end(), fuzzy.begin(), fuzzy.begin() + wanted);
+        return matches;
+    }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    // Most names one search checks for typos; about 0.2 ms worth.
+    static constexpr size_t maxChecks = 2048;
+
+    struct Entry {
+        std::string_view key;     // normalized, used for matching
+        std::string_view display; // as first seen
+        std::vector<int> ids;
+        uint32_t seen;            // searchStamp of the last search that looked at it
+    };
+
+    // The entry for name's normalized spelling, created (and indexed) if new.
+    uint32_t entryFor(std::string_view name) {
+        normalize(name, scratch);
+        auto it = byKey.find(scratch);
+        if (it != byKey.end()) return it->second;
+        uint32_t entry = static_cast<uint32_t>(entries.size());
+        std::string_view key = text.store(scratch.data(), scratch.size());
+        entries.push_back(Entry{ key, text.store(name.data(), name.size()), {}, 0 });
+        byKey.emplace(key, entry);
+        for (size_t i = 0; i < key.size(); ++i) {
+            if (i == 0 || key[i - 1] == ' ') words.emplace_back(entry, static_cast<uint32_t>(i));
+        }
+        for (uint32_t gram : keyGrams(key)) grams[gram].push_back(entry);
+        return entry;
+    }
+
+    // Lowercases ASCII letters, trims and collapses runs of whitespace. Runs
+    // once per row when the index is built, so it avoids the locale-aware
+    // <cctype> calls.
+    static void normalize(std::string_view text, std::string& out) {
+        out.resize(text.size());
+        size_t length = 0;
+        bool space = false;
+        for (char c : text) {
+            if (c == ' ' || (c >= '\t' && c <= '\r')) { space = true; continue; }
+            if (space && length > 0) out[length++] = ' ';
+            space = false;
+            out[length++] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+        out.resize(length);
+    }
+
+    // Posting key of the bigram or trigram at s; bigrams get bit 24 so the
+    // two kinds never collide.
+    static uint32_t gramKey(const char* s, size_t length) {
+        uint32_t key = length == 2 ? uint32_t(1) << 24 : 0;
+        for (size_t i = 0; i < length; ++i) key |= static_cast<uint32_t>(static_cast<unsigned char>(s[i])) << (8 * (length - 1 - i));
+        return key;
+    }
+
+    static std::vector<uint32_t> keyGrams(std::string_view key) {
+        std::vector<uint32_t> keys;
+        for (size_t i = 0; i + 2 <= key.size(); ++i) {
+            keys.push_back(gramKey(key.data() + i, 2));
+            if (i + 3 <= key.size()) keys.push_back(gramKey(key.data() + i, 3));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    // Cuts q (at least two characters per piece) into the given number of
+    // pieces so that the postings of each piece's rarest gram are as short
+    // as possible in total, and returns those postings, shortest first.
+    std::vector<const std::vector<uint32_t>*> pieceLists(const std::string& q, int pieces) {
+        static const std::vector<uint32_t> none;
+        const int n = static_cast<int>(q.size());
+        // at[i][length - 2]: postings of the gram of that length at i.
+        std::vector<std::array<const std::vector<uint32_t>*, 2>> at(n, { &none, &none });
+        for (int i = 0; i < n; ++i) {
+            for (int length = 2; length <= 3 && i + length <= n; ++length) {
+                auto it = grams.find(gramKey(q.data() + i, length));
+                if (it != grams.end()) at[i][length - 2] = &it->second;
+            }
+        }
+        // rarest[a][b]: rarest gram within q[a, b), grown one end at a time.
+        std::vector<std::vector<const std::vector<uint32_t>*>> rarest(n, std::vector<const std::vector<uint32_t>*>(n + 1, nullptr));
+        for (int a = 0; a < n; ++a) {
+            const std::vector<uint32_t>* best = nullptr;
+            for (int b = a + 2; b <= n; ++b) {
+                for (int length = 2; length <= 3 && b - length >= a; ++length) {
+                    const auto* list = at[b - length][length - 2];
+                    if (!best || list->size() < best->size()) best = list;
+                }
+                rarest[a][b] = best;
+            }
+        }
+        // cost[p][j]: least total postings covering q[0, j) with p pieces;
+        // cut[p][j] is where the last of them starts.
+        const size_t unreachable = SIZE_MAX;
+        std::vector<std::vector<size_t>> cost(pieces + 1, std::vector<size_t>(n + 1, unreachable));
+        std::vector<std::vector<int>> cut(pieces + 1, std::vector<int>(n + 1, 0));
+        cost[0][0] = 0;
+        for (int p = 1; p <= pieces; ++p) {
+            for (int j = 2 * p; j <= n; ++j) {
+                for (int a = 2 * (p - 1); a + 2 <= j; ++a) {
+                    if (cost[p - 1][a] == unreachable) continue;
+                    size_t total = cost[p - 1][a] + rarest[a][j]->size();
+                    if (total < cost[p][j]) { cost[p][j] = total; cut[p][j] = a; }
+                }
+            }
+        }
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (int p = pieces, j = n; p > 0; j = cut[p][j], --p) lists.push_back(rarest[cut[p][j]][j]);
+        std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        return lists;
+    }
+
+    std::string_view suffix(const std::pair<uint32_t, uint32_t>& word) const {
+        return entries[word.first].key.substr(word.second);
+    }
+
+    // Names added since the last search are sorted and merged in one step.
+    void sortPendingWords() {
+        if (sortedWords == words.size()) return;
+        auto less = [&](const auto& a, const auto& b) { return suffix(a) < suffix(b); };
+        std::sort(words.begin() + sortedWords, words.end(), less);
+        std::inplace_merge(words.begin(), words.begin() + sortedWords, words.end(), less);
+        sortedWords = words.size();
+    }
+
+    // Fewest edits turning the query into some substring of a name (Myers
+    // 1999, search variant), for queries of up to 64 characters.
+    class Pattern {
+    public:
+        explicit Pattern(std::string_view query) : length(static_cast<int>(query.size())) {
+            for (int i = 0; i < length; ++i) peq[static_cast<unsigned char>(query[i])] |= uint64_t(1) << i;
+        }
+
+        int distance(std::string_view text, int limit) const {
+            uint64_t pv = ~uint64_t(0), mv = 0;
+            uint64_t last = uint64_t(1) << (length - 1);
+            int score = length, best = length;
+            for (char c : text) {
+                uint64_t eq = peq[static_cast<unsigned char>(c)];
+                uint64_t xv = eq | mv;
+                uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                uint64_t ph = mv | ~(xh | pv);
+                uint64_t mh = pv & xh;
+                if (ph & last) score++;
+                else if (mh & last) score--;
+                ph <<= 1;
+                mh <<= 1;
+                pv = mh | ~(xv | ph);
+                mv = ph & xv;
+                if (score < best && (best = score) == 0) break;
+            }
+            return best <= limit ? best : limit + 1;
+        }
+
+    private:
+        uint64_t peq[256] = {};
+        int length;
+    };
+
+    StringArena text{ 64 * 1024 };
+    std::vector<Entry> entries;
+    std::unordered_map<std::string_view, uint32_t> byKey;
+    std::vector<std::pair<uint32_t, uint32_t>> words; // (entry, offset of a word start)
+    size_t sortedWords = 0;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> grams; // gramKey -> entries containing it
+    std::string scratch;
+    uint32_t searchStamp = 0;
+    bool isBuilt = false;
+};
+
+#endif // NAMEINDEX_H
@@ -0,0 +1,93 @@
+#ifndef PAGEWRITER_H
+#define PAGEWRITER_H
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "Money.h"
+
+// Collects a whole page of listing output in one string and writes it to
+// the terminal with a single call, instead of one stream insertion per field.
+class PageWriter {
+public:
+    explicit PageWriter(size_t reserveBytes = 64 * 1024) { buffer.reserve(reserveBytes); }
+
+    PageWriter& operator<<(std::string_view text) {
+        buffer.append(text.data(), text.size());
+        return *this;
+    }
+
+    // Text column straight from sqlite3_column_text(); NULL prints as empty.
+    PageWriter& operator<<(const unsigned char* text) {
+        if (text) buffer.append(reinterpret_cast<const char*>(text));
+        return *this;
+    }
+
+    PageWriter& operator<<(int value) {
+        char tmp[16];
+        int n = std::snprintf(tmp, sizeof(tmp), "%d", value);
+        buffer.append(tmp, n);
+        return *this;
+    }
+
+    // Dollar amount with two decimals, formatted from the exact cents.
+    PageWriter& money(Money value) {
+        char tmp[24];
+        buffer.append(tmp, value.format(tmp, sizeof(tmp)));
+        return *this;
+    }
+
+    // Quoted, escaped JSON string.
+    PageWriter& json(std::string_view text) {
+        buffer += '"';
+        for (char c : text) {
+            switch (c) {
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char tmp[8];
+                    std::snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+                    buffer += tmp;
+                }
+                else buffer += c;
+            }
+        }
+        buffer += '"';
+        return *this;
+    }
+
+    // CSV field, quoted (with "" escapes) only when it contains a comma,
+    // quote, line break or edge whitespace, so it re-imports unchanged.
+    PageWriter& csv(std::string_view text) {
+        bool quote = !text.empty() && (text.front() == ' ' || text.back() == ' ' ||
+            text.find_first_of(",\"\r\n") != std::string_view::npos);
+        if (!quote) return *this << text;
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"') buffer += '"';
+            buffer += c;
+        }
+        buffer += '"';
+        return *this;
+    }
+
+    size_t size() const { return buffer.size(); }
+    std::string_view view() const { return buffer; }
+    void clear() { buffer.clear(); }
+
+    void flush(std::ostream& out = std::cout) {
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        buffer.clear();
+    }
+
+private:
+    std::string buffer;
+};
+
+#endif // PAGEWRITER_H
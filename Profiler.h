@@ -0,0 +1,197 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sqlite3.h"
+
+// Call count, total and a log2 histogram of durations in nanoseconds.
+// Bucket i holds durations in [2^i, 2^(i+1)) ns, so percentiles are read
+// back as the upper bound of the bucket they fall in (within 2x).
+struct LatencyHistogram {
+    static constexpr int bucketCount = 48;
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t buckets[bucketCount] = {};
+
+    void add(uint64_t ns) {
+        count++;
+        totalNs += ns;
+        maxNs = std::max(maxNs, ns);
+        int bucket = 0;
+        while (bucket < bucketCount - 1 && (ns >> (bucket + 1)) != 0) bucket++;
+        buckets[bucket]++;
+    }
+
+    uint64_t percentileNs(double p) const {
+        uint64_t rank = static_cast<uint64_t>(p * count + 0.5);
+        uint64_t seen = 0;
+        for (int i = 0; i < bucketCount; ++i) {
+            seen += buckets[i];
+            if (seen >= rank && seen > 0) return std::min(maxNs, (uint64_t(2) << i) - 1);
+        }
+        return maxNs;
+    }
+};
+
+// Collects per-statement timings from sqlite3_trace_v2 and per-function
+// timings from ProfileScope. Nothing is hooked or measured until enable()
+// is called, so a disabled profiler costs one branch per instrumented
+// function and nothing per statement.
+//
+// A statement is timed from its first sqlite3_step() to its reset, the same
+// span SQLite's own profile event covers, but on the steady clock because
+// SQLite's timestamp is only millisecond-accurate on most platforms. For a
+// statement that streams rows this includes the caller's per-row work.
+class Profiler {
+public:
+    bool enabled() const { return on; }
+
+    void enable(sqlite3* db) {
+        on = true;
+        sqlite3_trace_v2(db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, &Profiler::traceCallback, this);
+    }
+
+    void recordFunction(const char* name, uint64_t ns) {
+        std::lock_guard<std::mutex> lock(mutex);
+        functions[name].add(ns);
+    }
+
+    void recordStatement(const char* sql, uint64_t ns) {
+        std::lock_guard<std::mutex> lock(mutex);
+        statements[sql].add(ns);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        functions.clear();
+        statements.clear();
+    }
+
+    // Writes both tables, slowest total first.
+    void report(std::ostream& out, bool json) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (json) {
+            out << "{\"functions\":";
+            writeJson(out, functions);
+            out << ",\"statements\":";
+            writeJson(out, statements);
+            out << "}\n";
+            return;
+        }
+        writeTable(out, "Function", functions);
+        writeTable(out, "Statement", statements);
+    }
+
+private:
+    using Table = std::map<std::string, LatencyHistogram, std::less<>>;
+
+    static int traceCallback(unsigned type, void* context, void* p, void* x) {
+        Profiler* self = static_cast<Profiler*>(context);
+        sqlite3_stmt* stmt = static_cast<sqlite3_stmt*>(p);
+        auto now = std::chrono::steady_clock::now();
+        if (type == SQLITE_TRACE_STMT) {
+            // Trigger bodies report "-- name" against their parent statement.
+            const char* text = static_cast<const char*>(x);
+            if (text && text[0] == '-' && text[1] == '-') return 0;
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->started[stmt] = now;
+        }
+        else if (type == SQLITE_TRACE_PROFILE) {
+            std::unique_lock<std::mutex> lock(self->mutex);
+            auto it = self->started.find(stmt);
+            if (it == self->started.end()) return 0;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->second).count();
+            self->started.erase(it);
+            lock.unlock();
+            const char* sql = sqlite3_sql(stmt);
+            self->recordStatement(sql ? sql : "?", static_cast<uint64_t>(ns));
+        }
+        return 0;
+    }
+
+    static std::vector<const Table::value_type*> byTotal(const Table& table) {
+        std::vector<const Table::value_type*> rows;
+        for (const auto& entry : table) rows.push_back(&entry);
+        std::sort(rows.begin(), rows.end(), [](auto a, auto b) { return a->second.totalNs > b->second.totalNs; });
+        return rows;
+    }
+
+    static void writeTable(std::ostream& out, const char* title, const Table& table) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "\n%-60s %8s %11s %9s %9s %9s %9s\n",
+            title, "calls", "total ms", "mean ms", "p50 ms", "p99 ms", "max ms");
+        out << line;
+        for (const auto* row : byTotal(table)) {
+            const LatencyHistogram& h = row->second;
+            std::string name = row->first.substr(0, 60);
+            std::replace(name.begin(), name.end(), '\n', ' ');
+            std::snprintf(line, sizeof(line), "%-60s %8llu %11.3f %9.3f %9.3f %9.3f %9.3f\n",
+                name.c_str(), (unsigned long long)h.count, h.totalNs / 1e6, h.totalNs / 1e6 / h.count,
+                h.percentileNs(0.50) / 1e6, h.percentileNs(0.99) / 1e6, h.maxNs / 1e6);
+            out << line;
+        }
+    }
+
+    static void writeJson(std::ostream& out, const Table& table) {
+        out << "[";
+        bool first = true;
+        for (const auto* row : byTotal(table)) {
+            const LatencyHistogram& h = row->second;
+            out << (first ? "" : ",") << "{\"name\":\"";
+            for (char c : row->first) {
+                if (c == '"' || c == '\\') out << '\\' << c;
+                else if (c == '\n') out << "\\n";
+                else if (static_cast<unsigned char>(c) >= 0x20) out << c;
+            }
+            out << "\",\"calls\":" << h.count << ",\"totalNs\":" << h.totalNs << ",\"maxNs\":" << h.maxNs
+                << ",\"p50Ns\":" << h.percentileNs(0.50) << ",\"p99Ns\":" << h.percentileNs(0.99) << ",\"histogram\":[";
+            int last = LatencyHistogram::bucketCount - 1;
+            while (last > 0 && h.buckets[last] == 0) last--;
+            for (int i = 0; i <= last; ++i) out << (i ? "," : "") << h.buckets[i];
+            out << "]}";
+            first = false;
+        }
+        out << "]";
+    }
+
+    bool on = false;
+    std::mutex mutex;
+    Table functions;
+    Table statements;
+    std::unordered_map<sqlite3_stmt*, std::chrono::steady_clock::time_point> started;
+};
+
+// Times the enclosing scope into profiler's function table when profiling
+// is on; otherwise only checks the flag.
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, const char* name)
+        : profiler(profiler.enabled() ? &profiler : nullptr), name(name) {
+        if (this->profiler) start = std::chrono::steady_clock::now();
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    ~ProfileScope() {
+        if (profiler) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            profiler->recordFunction(name, static_cast<uint64_t>(ns));
+        }
+    }
+
+private:
+    Profiler* profiler;
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // PROFILER_H
@@ -1,7 +1,15 @@
 #ifndef SALES_H
 #define SALES_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "Money.h"
+#include "NameIndex.h"
+#include "SnapshotFile.h"
+#include "StringPool.h"
 
 struct soldCard {
     int id;
@@ -12,12 +20,62 @@ struct soldCard {
     std::string cardNumber;
     std::string condition;
     std::string reference;
-    double purchasePrice;
-    double finalSoldPrice;
-    double profitMade;
+    Money purchasePrice;
+    Money finalSoldPrice;
+    Money profitMade;
     int quantitySold;
 };
 
+// Compact row for the loaded sales log; same layout rules as CardRow.
+struct SaleRow {
+    int id;
+    uint32_t type;
+    std::string_view name;
+    uint32_t setName;
+    std::string_view cardNumber;
+    uint32_t condition;
+    std::string_view reference;
+    Money purchasePrice;
+    Money finalSoldPrice;
+    Money profitMade;
+    int quantitySold;
+};
+
+struct SalesModel {
+    StringPool dictionary;
+    StringArena text;
+    std::vector<SaleRow> rows;
+    // Holds the snapshot file the rows' text points into when they were
+    // mapped instead of read through SQL.
+    std::unique_ptr<MappedFile> mapping;
+    // Database state the rows reflect; invalid until loaded.
+    SnapshotStamp stamp;
+    // Rows were patched in place since the snapshot was read or written.
+    bool patched = false;
+    // Names to row ids for the type-ahead picker. Built on first use and
+    // then kept current by patchRows, so only a full reload rebuilds it.
+    NameIndex names;
+
+    void clear() {
+        rows.clear();
+        text.clear();
+        mapping.reset();
+        stamp = SnapshotStamp();
+        patched = false;
+        names.clear();
+    }
+
+    bool empty() const { return rows.empty(); }
+    size_t size() const { return rows.size(); }
+};
+
+// One line of a checkout cart: sell `quantity` copies of inventory card
+// `cardId` at `pricePerCard` each.
+struct CheckoutLine {
+    int cardId;
+    int quantity;
+    Money pricePerCard;
+};
 
 #endif // SALES_H
 
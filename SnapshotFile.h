@@ -0,0 +1,288 @@
+#ifndef SNAPSHOTFILE_H
+#define SNAPSHOTFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "StringPool.h"
+
+// Read-only memory mapping of a whole file. Pages are only read from disk
+// when first touched, so opening even a large file is close to free.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { close(); return false; }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { close(); return false; }
+        bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!bytes) { close(); return false; }
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) { ::close(fd); return false; }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        bytes = static_cast<const char*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+    const char* bytes = nullptr;
+    size_t length = 0;
+};
+
+// The database state a snapshot was taken from: the schema version and the
+// table's change generation, which triggers bump on every write. Both are
+// stored in the database file, so unlike PRAGMA data_version they can be
+// compared across runs. generation < 0 means "unknown" and never matches.
+struct SnapshotStamp {
+    int64_t userVersion = -1;
+    int64_t generation = -1;
+
+    bool valid() const { return generation >= 0; }
+    bool operator==(const SnapshotStamp& other) const {
+        return valid() && userVersion == other.userVersion && generation == other.generation;
+    }
+};
+
+// File layout, in host byte order with every section 8-byte aligned:
+//   SnapshotHeader
+//   dictionary  dictionaryCount SnapshotText entries (StringPool ids 0..n-1)
+//   columns     one array of rowCount values per entry of header.columns
+//   heap        heapSize bytes of string data, addressed by SnapshotText
+enum SnapshotColumnKind : uint32_t {
+    Int32Column = 1,     // int32_t
+    DoubleColumn = 2,    // double
+    DictionaryColumn = 3, // uint32_t id into the dictionary
+    TextColumn = 4,      // SnapshotText into the heap
+    Int64Column = 5,     // int64_t, e.g. Money cents
+};
+
+struct SnapshotText {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SnapshotHeader {
+    static constexpr uint32_t currentFormat = 1;
+    static constexpr size_t maxColumns = 16;
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t columnCount;
+    int64_t userVersion;
+    int64_t generation;
+    uint64_t rowCount;
+    uint64_t dictionaryCount;
+    uint64_t heapSize;
+    uint32_t columns[maxColumns];
+};
+
+inline constexpr char snapshotMagic[8] = { 'T', 'C', 'D', 'B', 'S', 'N', 'A', 'P' };
+
+inline size_t snapshotColumnWidth(uint32_t kind) {
+    switch (kind) {
+    case Int32Column: return sizeof(int32_t);
+    case DoubleColumn: return sizeof(double);
+    case DictionaryColumn: return sizeof(uint32_t);
+    case TextColumn: return sizeof(SnapshotText);
+    case Int64Column: return sizeof(int64_t);
+    default: return 0;
+    }
+}
+
+inline size_t snapshotAlign(size_t size) { return (size + 7) & ~size_t(7); }
+
+// Builds a snapshot column by column. Each column function takes a getter
+// called with every row index in order.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(size_t rowCount) : rowCount(rowCount) {}
+
+    void dictionary(const StringPool& pool) {
+        for (size_t i = 0; i < pool.size(); ++i) entries.push_back(addText(pool.get(static_cast<uint32_t>(i))));
+    }
+
+    template <typename Get> void int32Column(Get get) { append<int32_t>(Int32Column, get); }
+    template <typename Get> void doubleColumn(Get get) { append<double>(DoubleColumn, get); }
+    template <typename Get> void int64Column(Get get) { append<int64_t>(Int64Column, get); }
+    template <typename Get> void dictionaryColumn(Get get) { append<uint32_t>(DictionaryColumn, get); }
+    template <typename Get> void textColumn(Get get) {
+        append<SnapshotText>(TextColumn, [&](size_t i) { return addText(get(i)); });
+    }
+
+    // Writes to a temporary file and renames it over path, so a reader never
+    // maps a half-written snapshot.
+    bool save(const std::string& path, const SnapshotStamp& stamp) const {
+        if (overflow || kinds.size() > SnapshotHeader::maxColumns || !stamp.valid()) return false;
+        SnapshotHeader header = {};
+        std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+        header.formatVersion = SnapshotHeader::currentFormat;
+        header.columnCount = static_cast<uint32_t>(kinds.size());
+        header.userVersion = stamp.userVersion;
+        header.generation = stamp.generation;
+        header.rowCount = rowCount;
+        header.dictionaryCount = entries.size();
+        header.heapSize = heap.size();
+        for (size_t i = 0; i < kinds.size(); ++i) header.columns[i] = kinds[i];
+
+        std::string temp = path + ".tmp";
+        FILE* file = std::fopen(temp.c_str(), "wb");
+        if (!file) return false;
+        static const char padding[8] = {};
+        size_t dictionaryBytes = entries.size() * sizeof(SnapshotText);
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+            && (entries.empty() || std::fwrite(entries.data(), dictionaryBytes, 1, file) == 1)
+            && std::fwrite(padding, 1, snapshotAlign(dictionaryBytes) - dictionaryBytes, file) == snapshotAlign(dictionaryBytes) - dictionaryBytes
+            && (body.empty() || std::fwrite(body.data(), body.size(), 1, file) == 1)
+            && (heap.empty() || std::fwrite(heap.data(), heap.size(), 1, file) == 1);
+        ok = std::fclose(file) == 0 && ok;
+        if (ok) std::remove(path.c_str()); // rename() will not replace a file on Windows
+        if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    template <typename T, typename Get>
+    void append(uint32_t kind, Get get) {
+        kinds.push_back(kind);
+        size_t start = body.size();
+        body.resize(start + snapshotAlign(rowCount * sizeof(T)));
+        char* out = &body[start];
+        for (size_t i = 0; i < rowCount; ++i) {
+            T value = static_cast<T>(get(i));
+            std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+        }
+    }
+
+    SnapshotText addText(std::string_view text) {
+        if (heap.size() + text.size() > UINT32_MAX) {
+            overflow = true;
+            return SnapshotText{ 0, 0 };
+        }
+        SnapshotText entry{ static_cast<uint32_t>(heap.size()), static_cast<uint32_t>(text.size()) };
+        heap.append(text.data(), text.size());
+        return entry;
+    }
+
+    size_t rowCount;
+    std::vector<uint32_t> kinds;
+    std::vector<SnapshotText> entries;
+    std::string body;
+    std::string heap;
+    bool overflow = false;
+};
+
+// Maps a snapshot and exposes its columns in place. open() only succeeds for
+// a complete file of the expected column layout taken at the given stamp;
+// anything else (missing, stale, truncated, other format) reads as a miss.
+class SnapshotReader {
+public:
+    bool open(const std::string& path, const SnapshotStamp& stamp, const std::vector<uint32_t>& expectedColumns) {
+        file = std::make_unique<MappedFile>();
+        if (!stamp.valid() || !file->open(path) || file->size() < sizeof(SnapshotHeader)) return false;
+        const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file->data());
+        if (std::memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0
+            || header->formatVersion != SnapshotHeader::currentFormat
+            || header->userVersion != stamp.userVersion || header->generation != stamp.generation
+            || header->columnCount != expectedColumns.size()) return false;
+
+        rowCount = static_cast<size_t>(header->rowCount);
+        dictionaryCount = static_cast<size_t>(header->dictionaryCount);
+        size_t offset = sizeof(SnapshotHeader);
+        dictionary = reinterpret_cast<const SnapshotText*>(file->data() + offset);
+        offset += snapshotAlign(dictionaryCount * sizeof(SnapshotText));
+        columns.clear();
+        for (size_t i = 0; i < expectedColumns.size(); ++i) {
+            if (header->columns[i] != expectedColumns[i]) return false;
+            columns.push_back(file->data() + offset);
+            offset += snapshotAlign(rowCount * snapshotColumnWidth(expectedColumns[i]));
+        }
+        heap = file->data() + offset;
+        heapSize = static_cast<size_t>(header->heapSize);
+        return offset + heapSize == file->size();
+    }
+
+    size_t rows() const { return rowCount; }
+    size_t dictionarySize() const { return dictionaryCount; }
+    std::string_view dictionaryEntry(size_t i) const { return text(dictionary[i]); }
+
+    const int32_t* int32Column(size_t column) const { return reinterpret_cast<const int32_t*>(columns[column]); }
+    const double* doubleColumn(size_t column) const { return reinterpret_cast<const double*>(columns[column]); }
+    const int64_t* int64Column(size_t column) const { return reinterpret_cast<const int64_t*>(columns[column]); }
+    const uint32_t* dictionaryColumn(size_t column) const { return reinterpret_cast<const uint32_t*>(columns[column]); }
+    const SnapshotText* textColumn(size_t column) const { return reinterpret_cast<const SnapshotText*>(columns[column]); }
+
+    // A view into the mapping; out-of-range entries read as empty.
+    std::string_view text(const SnapshotText& entry) const {
+        if (entry.offset > heapSize || entry.length > heapSize - entry.offset) return std::string_view();
+        return std::string_view(heap + entry.offset, entry.length);
+    }
+
+    // Hands over the mapping, which must outlive every view taken from it.
+    std::unique_ptr<MappedFile> release() { return std::move(file); }
+
+private:
+    std::unique_ptr<MappedFile> file;
+    size_t rowCount = 0;
+    size_t dictionaryCount = 0;
+    const SnapshotText* dictionary = nullptr;
+    std::vector<const char*> columns;
+    const char* heap = nullptr;
+    size_t heapSize = 0;
+};
+
+#endif // SNAPSHOTFILE_H
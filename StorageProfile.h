@@ -0,0 +1,38 @@
+#ifndef STORAGEPROFILE_H
+#define STORAGEPROFILE_H
+
+#include <cstring>
+
+// Connection-level storage settings applied as PRAGMAs. See
+// applyStorageProfile() and the profile notes in the README.
+struct StorageProfile {
+    const char* name;
+    const char* journalMode;   // PRAGMA journal_mode
+    const char* synchronous;   // PRAGMA synchronous
+    long long mmapSize;        // PRAGMA mmap_size, bytes
+    int cacheSize;             // PRAGMA cache_size, negative = KiB
+    const char* tempStore;     // PRAGMA temp_store
+    int walAutoCheckpoint;     // PRAGMA wal_autocheckpoint, pages; 0 = off
+    bool checkpointOnLeave;    // TRUNCATE-checkpoint the WAL when switching away
+};
+
+// durable:   rollback journal, fsync on every commit. Slowest writes, nothing
+//            to checkpoint, safest against power loss.
+// balanced:  WAL with synchronous=NORMAL. A commit is one WAL append without
+//            fsync; only a power cut (not a crash) can lose the last commits.
+// bulk-load: WAL with syncing and auto-checkpointing off and a large cache,
+//            for imports and batch runs; the WAL is folded back once at the end.
+const StorageProfile storageProfiles[] = {
+    { "durable",   "DELETE", "FULL",   0,                 -16000,  "DEFAULT", 1000, false },
+    { "balanced",  "WAL",    "NORMAL", 256LL << 20,       -64000,  "MEMORY",  1000, false },
+    { "bulk-load", "WAL",    "OFF",    1LL << 30,         -256000, "MEMORY",  0,    true  },
+};
+
+inline const StorageProfile* findStorageProfile(const char* name) {
+    for (const StorageProfile& profile : storageProfiles) {
+        if (std::strcmp(profile.name, name) == 0) return &profile;
+    }
+    return nullptr;
+}
+
+#endif // STORAGEPROFILE_H
@@ -0,0 +1,68 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Bump allocator for row text. Strings are copied into large blocks and
+// handed back as string_views, so loading N rows costs a handful of block
+// allocations instead of one heap allocation per field. Views stay valid
+// until clear().
+class StringArena {
+public:
+    explicit StringArena(size_t blockSize = 256 * 1024) : blockSize(blockSize) {}
+
+    std::string_view store(const char* data, size_t size) {
+        if (size == 0) return std::string_view();
+        if (blocks.empty() || used + size > capacity) {
+            capacity = size > blockSize ? size : blockSize;
+            blocks.emplace_back(new char[capacity]);
+            used = 0;
+        }
+        char* dest = blocks.back().get() + used;
+        std::memcpy(dest, data, size);
+        used += size;
+        return std::string_view(dest, size);
+    }
+
+    void clear() {
+        blocks.clear();
+        used = capacity = 0;
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockSize;
+    size_t used = 0;
+    size_t capacity = 0;
+};
+
+// Dictionary for low-cardinality text such as type, set and condition.
+// Each distinct value is stored once and rows keep a small integer id.
+class StringPool {
+public:
+    uint32_t intern(std::string_view value) {
+        auto it = ids.find(value);
+        if (it != ids.end()) return it->second;
+        std::string_view stored = text.store(value.data(), value.size());
+        uint32_t id = static_cast<uint32_t>(values.size());
+        values.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    std::string_view get(uint32_t id) const { return values[id]; }
+    size_t size() const { return values.size(); }
+
+private:
+    StringArena text{ 16 * 1024 };
+    std::vector<std::string_view> values;
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+#endif // STRINGPOOL_H
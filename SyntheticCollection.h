@@ -0,0 +1,98 @@
+#ifndef SYNTHETICCOLLECTION_H
+#define SYNTHETICCOLLECTION_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+// Deterministic generator of realistic-looking collections for the
+// benchmark mode. It uses its own PRNG and inverse-CDF sampling instead of
+// <random> distributions (whose output differs between standard libraries),
+// so the same seed and row count give the same collection on every build.
+class SyntheticCollection {
+public:
+    explicit SyntheticCollection(uint64_t seed = 0x7C0DB5EEDULL) : state(seed) {
+        // Set popularity follows a Zipf curve: a few flagship sets hold most
+        // of the cards, with a long tail of sets owning a handful each.
+        double total = 0;
+        for (int i = 0; i < setCount; ++i) {
+            total += 1.0 / std::pow(i + 1, 1.1);
+            setCdf.push_back(total);
+        }
+        for (double& c : setCdf) c /= total;
+    }
+
+    // Writes a CSV in the import format (header plus rows).
+    void writeCsv(std::ostream& out, size_t rows) {
+        out << "type,name,setName,cardNumber,condition,reference,purchasePrice,ebayCompValue,quantity\n";
+        char line[256];
+        for (size_t i = 0; i < rows; ++i) {
+            int type = pick(typeWeights, typeCount);
+            int set = pickSet();
+            int condition = pick(conditionWeights, conditionCount);
+            // Log-normal prices: most cards are cheap, a few are worth a lot.
+            double purchase = std::exp(1.0 + 1.3 * normal());
+            double comp = purchase * std::exp(0.15 + 0.4 * normal()) * conditionFactor[condition];
+            int quantity = 1 + static_cast<int>(uniform() * uniform() * 10);
+            int n = std::snprintf(line, sizeof(line), "%s,%s Player %u,%s %d,%u,%s,R%zu,%.2f,%.2f,%d\n",
+                types[type], types[type], static_cast<unsigned>(next() % 5000),
+                types[type], set, static_cast<unsigned>(next() % 700 + 1),
+                conditions[condition], i, purchase, comp, quantity);
+            out.write(line, n);
+        }
+    }
+
+    uint64_t next() {
+        // splitmix64
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    static constexpr int typeCount = 6;
+    static constexpr int conditionCount = 6;
+    static constexpr int setCount = 400;
+    static constexpr const char* types[typeCount] = { "Baseball", "Pokemon", "Basketball", "Football", "Magic", "Hockey" };
+    static constexpr double typeWeights[typeCount] = { 0.38, 0.24, 0.16, 0.12, 0.07, 0.03 };
+    static constexpr const char* conditions[conditionCount] = { "NM", "LP", "MP", "HP", "PSA 10", "DMG" };
+    static constexpr double conditionWeights[conditionCount] = { 0.45, 0.25, 0.14, 0.08, 0.05, 0.03 };
+    static constexpr double conditionFactor[conditionCount] = { 1.0, 0.8, 0.6, 0.4, 4.0, 0.2 };
+
+    int pick(const double* weights, int count) {
+        double u = uniform();
+        for (int i = 0; i < count - 1; ++i) {
+            if (u < weights[i]) return i;
+            u -= weights[i];
+        }
+        return count - 1;
+    }
+
+    int pickSet() {
+        double u = uniform();
+        size_t lo = 0, hi = setCdf.size() - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (setCdf[mid] < u) lo = mid + 1; else hi = mid;
+        }
+        return static_cast<int>(lo);
+    }
+
+    // Standard normal via Box-Muller.
+    double normal() {
+        double u1 = uniform();
+        double u2 = uniform();
+        if (u1 < 1e-300) u1 = 1e-300;
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    uint64_t state;
+    std::vector<double> setCdf;
+};
+
+#endif // SYNTHETICCOLLECTION_H
@@ -0,0 +1,138 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <cstdio>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <conio.h>
+#include <io.h>
+#else
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// One keystroke from KeyReader, reduced to what the pickers act on.
+struct KeyPress {
+    enum Kind { Char, Enter, Backspace, Up, Down, Cancel, Other };
+    Kind kind;
+    char ch; // the byte typed, for Char
+};
+
+// Reads single keystrokes without echo or waiting for Enter, for as long as
+// the object lives; the console is put back as it was afterwards. Ctrl+C
+// arrives as a Cancel key rather than a signal. ANSI cursor sequences work
+// on output meanwhile (enabled explicitly on Windows consoles).
+class KeyReader {
+public:
+    // False when input or output is not an interactive console (piped,
+    // redirected), in which case callers should read whole lines instead.
+    static bool available() {
+#ifdef _WIN32
+        return _isatty(_fileno(stdin)) && _isatty(_fileno(stdout));
+#else
+        return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+#endif
+    }
+
+    // Width of the console in characters (80 if it cannot be told).
+    static int columns() {
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return info.srWindow.Right - info.srWindow.Left + 1;
+#else
+        winsize size;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) return size.ws_col;
+#endif
+        return 80;
+    }
+
+    KeyReader() {
+#ifdef _WIN32
+        output = GetStdHandle(STD_OUTPUT_HANDLE);
+        if (GetConsoleMode(output, &savedMode)) {
+            SetConsoleMode(output, savedMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+            restore = true;
+        }
+#else
+        if (tcgetattr(STDIN_FILENO, &saved) == 0) {
+            termios raw = saved;
+            raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            restore = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+        }
+#endif
+    }
+
+    KeyReader(const KeyReader&) = delete;
+    KeyReader& operator=(const KeyReader&) = delete;
+
+    ~KeyReader() {
+        if (!restore) return;
+#ifdef _WIN32
+        SetConsoleMode(output, savedMode);
+#else
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+#endif
+    }
+
+    KeyPress read() {
+#ifdef _WIN32
+        int c = _getch();
+        if (c == 0 || c == 0xE0) {
+            int code = _getch();
+            return { code == 72 ? KeyPress::Up : code == 80 ? KeyPress::Down : KeyPress::Other, 0 };
+        }
+#else
+        int c = readByte();
+        if (c == 27) {
+            // A lone Esc, or the start of an arrow-key sequence (ESC [ A).
+            if (!pending(30)) return { KeyPress::Cancel, 0 };
+            int introducer = readByte();
+            if (introducer != '[' && introducer != 'O') return { KeyPress::Other, 0 };
+            int code = readByte();
+            while (code >= '0' && code <= '9') code = readByte(); // e.g. ESC [ 3 ~
+            return { code == 'A' ? KeyPress::Up : code == 'B' ? KeyPress::Down : KeyPress::Other, 0 };
+        }
+#endif
+        switch (c) {
+        case -1:
+        case 3:
+        case 4:
+        case 27: return { KeyPress::Cancel, 0 };
+        case '\r':
+        case '\n': return { KeyPress::Enter, 0 };
+        case 8:
+        case 127: return { KeyPress::Backspace, 0 };
+        case '\t': return { KeyPress::Down, 0 };
+        }
+        if (static_cast<unsigned char>(c) < 0x20) return { KeyPress::Other, 0 };
+        return { KeyPress::Char, static_cast<char>(c) };
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE output = nullptr;
+    DWORD savedMode = 0;
+#else
+    static int readByte() {
+        unsigned char c;
+        return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+    }
+
+    static bool pending(int milliseconds) {
+        pollfd fd{ STDIN_FILENO, POLLIN, 0 };
+        return poll(&fd, 1, milliseconds) > 0;
+    }
+
+    termios saved{};
+#endif
+    bool restore = false;
+};
+
+#endif // TERMINAL_H